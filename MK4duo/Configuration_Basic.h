@@ -51,6 +51,17 @@
  */
 #define SERIAL_PORT 0
 
+/**
+ * Second serial port for a host, with its own line buffer and line numbers.
+ * Lines from both ports are taken in turn and each reply goes to the port
+ * the command came from. A status query (M27 M31 M105 M114 M115 M119)
+ * from a port with no commands of its own in the queue is answered at once,
+ * so a monitoring host never takes queue slots from a streaming one.
+ *
+ * Valid values are 0-3 for Serial, Serial1, Serial2, Serial3 and -1 for SerialUSB
+ */
+//#define SERIAL_PORT_2 -1
+
 /**
  * This setting determines the communication speed of the printer.
  *
@@ -94,7 +105,9 @@
  * Milliseconds
  */
 #define NO_TIMEOUTS 1000
-// Uncomment to include more info in ok command
+// Uncomment to include more info in ok command:
+// ok N<line> P<planner blocks free> B<commands that still fit the queue> L<last line received>
+// Reported by M115 as Cap:ADVANCED_OK, see scripts/advanced_ok.py
 //#define ADVANCED_OK
 
 /**
@@ -107,9 +120,22 @@
 
 /**
  * Spend 28 bytes of SRAM to optimize the GCode parser
+ * Queued commands are also decoded once, while they wait,
+ * so handlers read their values without parsing text.
  */
 //#define FASTER_GCODE_PARSER
 
+/**
+ * Binary G-code transport
+ *
+ * After M575 S1 the host may send framed binary commands alongside
+ * ASCII lines: opcode, parameter mask, 4 byte values, sequence number
+ * and CRC16. See scripts/binary_gcode.py for the format and a streamer.
+ * Commands with a string argument (M23, M117...) stay ASCII.
+ * Requires FASTER_GCODE_PARSER
+ */
+//#define BINARY_GCODE_TRANSPORT
+
 /**
  * Host Keepalive
  *
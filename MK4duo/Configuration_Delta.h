@@ -309,6 +309,12 @@
 //#define PROBING_HEATERS_OFF       // Turn heaters off when probing
 //#define PROBING_FANS_OFF          // Turn fans off when probing
 
+// Start G29 probing as soon as the heating bed is within this many degrees of
+// its target, and let it finish heating while the grid is probed. Put the M190
+// after G29 in the start code to overlap heat-up and leveling.
+// Not compatible with PROBING_HEATERS_OFF.
+//#define PROBE_BED_TEMP_BAND 5
+
 // Use the LCD controller for bed leveling
 // Requires MESH BED LEVELING or PROBE MANUALLY
 //#define LCD_BED_LEVELING
@@ -465,6 +471,22 @@
 //#define Z_PROBE_END_SCRIPT "G1 Z10 F8000\nG1 X10 Y10\nG1 Z0.5"
 /*****************************************************************************************/
 
+/*****************************************************************************************
+ ******************************* Mesh Temperature Bank ***********************************
+ *****************************************************************************************
+ *                                                                                       *
+ * Keep several meshes in EEPROM, each tagged with the bed temperature it was            *
+ * probed at. When M190 finishes or leveling is enabled, the mesh nearest to the         *
+ * bed target is loaded, or the two bracketing meshes are linearly interpolated.         *
+ * M323 lists, saves, loads and clears the slots. All slots share the grid geometry.     *
+ * ONLY FOR UNIFIED BED LEVELING OR AUTO BED LEVELING BILINEAR, requires EEPROM_SETTINGS *
+ *                                                                                       *
+ *****************************************************************************************/
+//#define MESH_TEMPERATURE_BANK
+// Maximum number of temperature tagged slots
+#define MESH_BANK_SLOTS 8
+/*****************************************************************************************/
+
 
 /*****************************************************************************************
  ********************************* Auto Calibration **************************************
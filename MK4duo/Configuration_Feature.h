@@ -1135,6 +1135,73 @@
 //#define SD_CHECK_AND_RETRY  // Use CRC checks and retries on the SD communication
 //#define SD_EXTENDED_DIR     // Show extended directory including file length. Don't use this with Pronterface
 
+// Read the printing file ahead while the printer is idle, in multi-block reads,
+// with the next cluster of the file looked up before it is needed.
+// Takes SD_READ_AHEAD_BLOCKS * 512 bytes of RAM, 2 is fine on AVR, 4 or more on DUE.
+// Idle time refills once half the blocks are read, at most SD_READ_AHEAD_IDLE_BLOCKS
+// at a time (about 0.6ms each at 8MHz SPI) so the main loop is never held long.
+// With 2 blocks each refill is a single block, 4 or more make them multi-block.
+//#define SD_READ_AHEAD
+#define SD_READ_AHEAD_BLOCKS 2
+#define SD_READ_AHEAD_IDLE_BLOCKS 4
+
+// Write-back buffer for M28 uploads and M928 logging. Lines wait in RAM and go
+// to the card as whole blocks, in multi-block writes. The block in progress and
+// the file size in the folder are written every SD_WRITE_BUFFER_FLUSH seconds,
+// at M29 and before the card is released: a reset loses at most that much.
+// Takes SD_WRITE_BUFFER_BLOCKS * 512 bytes of RAM.
+//#define SD_WRITE_BUFFER
+#define SD_WRITE_BUFFER_BLOCKS 2
+#define SD_WRITE_BUFFER_FLUSH 10
+
+// Binary upload (M577): the file is allocated contiguous and sent in 512 byte
+// chunks with sequence number and CRC, written with one multi-block write.
+// scripts/sd_upload.py sends files this way.
+//#define SD_BINARY_UPLOAD
+
+// Index of the folder shown in the LCD or Nextion file list. The folder is read
+// once when it is opened, then each name shown is read from where the index
+// says it is, instead of walking the folder again for every line. Folders with
+// more than SD_DIR_INDEX_SIZE files are listed without index.
+// Takes 3 bytes of RAM per file, SD_DIR_INDEX_KEY more with SD_DIR_INDEX_SORT.
+//#define SD_DIR_INDEX
+#define SD_DIR_INDEX_SIZE 128
+// List folders first, then files by name. The first SD_DIR_INDEX_KEY characters
+// of each name are kept to sort, longer names that begin the same are read again.
+//#define SD_DIR_INDEX_SORT
+#define SD_DIR_INDEX_KEY 4
+
+// Job info (M36 and the layer table) kept for each file in the JOBINFO folder.
+// When a file is first selected, written or uploaded, its slicer comments are
+// read and the file is scanned in idle time for lines and layer starts.
+// While the file prints the scan follows the lines the print reads, so the
+// first print builds the table with no extra reads.
+// After that the info is read from JOBINFO, until the file changes.
+// The table has the start of every layer, or of one layer every 2, 4... in
+// SD_GCODE_INFO_LAYERS entries, each with Z, E and tool there, so M415 can
+// print a file from a layer. Takes about 200 bytes of RAM plus 20 per entry.
+//#define SD_GCODE_INFO
+#define SD_GCODE_INFO_LAYERS 32
+
+// Print time estimate (needs SD_GCODE_INFO): the scan runs the moves of the file
+// through the speed, acceleration and jerk limits of the planner, with a look-ahead
+// of SD_PRINT_TIME_BLOCKS moves, and keeps the time in JOBINFO. M27 and M73
+// report the time left of the print. Heating and pauses are not counted.
+//#define SD_PRINT_TIME
+#define SD_PRINT_TIME_BLOCKS 8
+
+// Power-loss journal: while printing from SD a 512 byte record of where the print
+// is (file, line feeding the oldest planned move, position, temperatures, fans,
+// tool, leveling) goes to one of POWER_LOSS_JOURNAL_RECORDS sectors of JOURNAL.BIN,
+// round-robin, every POWER_LOSS_JOURNAL_TIME seconds and when Z rises above where
+// it has been. M413 reports the newest record, M414 resumes from it.
+// Takes 20 bytes of RAM per planner block and about 140 more.
+//#define POWER_LOSS_JOURNAL
+#define POWER_LOSS_JOURNAL_RECORDS 8
+#define POWER_LOSS_JOURNAL_TIME 30
+#define POWER_LOSS_JOURNAL_LAYER
+#define POWER_LOSS_JOURNAL_PURGE 5  // mm of filament primed before the print goes on
+
 // Decomment this if you have external SD without DETECT_PIN
 //#define SD_DISABLED_DETECT
 // Some RAMPS and other boards don't detect when an SD card is inserted. You can work
@@ -1851,6 +1918,9 @@
 
 // The ASCII buffer for receiving from the serial:
 #define MAX_CMD_SIZE 96
+// The command queue takes BUFSIZE * MAX_CMD_SIZE bytes and a command header. Commands are stored
+// with their own length: with BUFSIZE 4 about 11 short G1 moves fit, about 6 with
+// FASTER_GCODE_PARSER, which keeps 14 bytes and 4 per parameter for each decoded command.
 // For Arduino DUE setting to 8
 #define BUFSIZE 4
 
@@ -1860,9 +1930,10 @@
 // To buffer a simple "ok" you need 4 bytes.
 // For ADVANCED_OK (M105) you need 32 bytes.
 // For debug-echo: 128 bytes for the optimal speed.
-// Other output doesn't need to be that speedy.
+// With 128 M105/M114 replies are queued whole and never stall the main loop,
+// M576 reports how often writes still waited for room.
 // 0, 2, 4, 8, 16, 32, 64, 128, 256
-#define TX_BUFFER_SIZE 32
+#define TX_BUFFER_SIZE 128
 
 // Host Receive Buffer Size
 // Without XON/XOFF flow control (see SERIAL XON XOFF below) 32 bytes should be enough.
@@ -112,6 +112,9 @@
 
 // SD
 #include "src/sd/cardreader.h"
+#include "src/sd/printtime.h"
+#include "src/sd/gcodeinfo.h"
+#include "src/sd/journal.h"
 
 // Utility
 #include "src/utility/utility.h"
@@ -0,0 +1,310 @@
+#!/usr/bin/python3
+
+# Streamer using the MK4duo ADVANCED_OK acknowledgement
+#
+#   ok N<line> P<planner blocks free> B<commands that still fit the queue>
+#      L<last line taken from the serial buffer>
+#
+# Plain hosts send a line and wait for its ok, so the queue holds one
+# command and the planner runs dry on short segments. With ADVANCED_OK
+# the host knows the lines after L are still on the way or in the RX
+# buffer, and keeps sending while
+#
+#   - those lines fit the B commands the queue can still take, and
+#   - their bytes fit the serial RX buffer.
+#
+# Stream a file:      advanced_ok.py -p /dev/ttyACM0 -b 250000 file.gcode
+# Simulate:           advanced_ok.py --loopback [file.gcode]
+#
+# --loopback runs the streamer against a model of the firmware (serial
+# link, RX buffer, byte-ring command queue, planner) for plain and
+# advanced acks and prints how full the queue and planner were.
+# --bufsize, --max-cmd-size and --entry-head give the queue of the build.
+# Without a file it streams 2000 0.2mm segments. Needs pyserial for -p.
+
+import argparse
+import re
+import time
+
+CMD_RECORD_HEAD = 14
+STRING_CODES = ('M23', 'M28', 'M30', 'M36', 'M117', 'M118', 'M577', 'M928')
+OK_LINE = re.compile(r'ok\b(?:.*?\bN(-?\d+))?(?:.*?\bP(-?\d+))?(?:.*?\bB(-?\d+))?(?:.*?\bL(-?\d+))?')
+
+
+def strip(line):
+    return line.split(';', 1)[0].strip()
+
+
+def numbered(line, n):
+    cmd = 'N%d %s' % (n, line)
+    cs = 0
+    for c in cmd.encode():
+        cs ^= c
+    return '%s*%d\n' % (cmd, cs)
+
+
+def parse_ok(reply):
+    """N, P, B, L of an ok line, None for each one missing"""
+    m = OK_LINE.match(reply)
+    if not m:
+        return None
+    return tuple(None if v is None else int(v) for v in m.groups())
+
+
+class Host:
+    """Decides when the next line may go, from the acks seen so far"""
+    def __init__(self, advanced, rx_buffer):
+        self.advanced = advanced
+        self.rx_buffer = rx_buffer
+        self.unacked = 0
+        self.acked = 0
+        self.sizes = {}         # Bytes of each line the firmware hasn't taken yet
+        self.free = 1           # B of the last ok
+
+    def may_send(self, n, size):
+        if not self.advanced or self.unacked == 0:
+            return self.unacked == 0
+        return len(self.sizes) < self.free and sum(self.sizes.values()) + size <= self.rx_buffer
+
+    def sent(self, n, size):
+        self.unacked += 1
+        self.sizes[n] = size
+
+    def resend(self, n):
+        """Lines from n on were flushed, an ok follows the request"""
+        for k in [k for k in self.sizes if k >= n]:
+            del self.sizes[k]
+        self.unacked = max(n - 1 - self.acked, 0) + 1
+        self.acked -= 1
+
+    def ok(self, reply):
+        self.unacked = max(self.unacked - 1, 0)
+        self.acked += 1
+        if reply[2] is not None and reply[3] is not None:
+            self.free = reply[2]
+            for n in [k for k in self.sizes if k <= reply[3]]:
+                del self.sizes[n]
+
+
+class Firmware:
+    """Serial RX buffer, command queue and planner, as Commands and Planner run them"""
+    def __init__(self, queue_size, max_cmd_size, entry_head, rx_size, blocks, segment_ms, loop_ms):
+        self.queue_size = queue_size
+        self.max_cmd_size = max_cmd_size
+        self.entry_head = entry_head
+        self.rx_size = rx_size
+        self.blocks = blocks
+        self.segment_ms = segment_ms
+        self.loop_ms = loop_ms
+        self.rx = bytearray()
+        self.queue = []           # (line number, entry bytes)
+        self.ready = None         # Line read from RX, waiting for room in the queue
+        self.last_n = 0           # gcode_LastN
+        self.used = 0
+        self.planned = 0
+        self.block_done = None    # When the head block finishes
+        self.overflow = 0
+        self.lost = 0
+
+    def receive(self, byte):
+        if len(self.rx) >= self.rx_size - 1:
+            self.overflow += 1
+        else:
+            self.rx.append(byte)
+
+    def entry_size(self, text):
+        """Header, text and the record of each parameter after the command word"""
+        word, _, rest = text.partition(' ')
+        params = 0 if word in STRING_CODES else len(set(c for c in rest if 'A' <= c <= 'Z'))
+        size = len(text) + 1 + CMD_RECORD_HEAD + 4 * params
+        return self.entry_head + (size if size <= self.max_cmd_size else len(text) + 1)
+
+    def fetch(self):
+        """get_serial_commands: whole lines into the queue while each one fits"""
+        while True:
+            if self.ready is None:
+                end = self.rx.find(b'\n')
+                if end < 0:
+                    return
+                line = self.rx[:end].decode()
+                del self.rx[:end + 1]
+                m = re.match(r'N(\d+) (.*)\*\d+$', line)
+                if not m:
+                    self.lost += 1      # The firmware would ask for a resend
+                    continue
+                n, text = int(m.group(1)), m.group(2)
+                self.ready = (n, self.entry_size(text))
+                self.last_n = n
+            n, size = self.ready
+            if self.queue_size - self.used < size:
+                return
+            self.queue.append(self.ready)
+            self.used += size
+            self.ready = None
+
+    def ack(self, n):
+        count = len(self.queue)
+        free = self.queue_size - self.used
+        b = free * count // self.used if count else self.queue_size // (self.entry_head + self.max_cmd_size)
+        if self.ready is not None:
+            b = max(b - 1, 0)
+        return 'ok N%d P%d B%d L%d\n' % (n, self.blocks - self.planned - 1, b, self.last_n)
+
+    def step(self, now):
+        """Run the planner to now, then execute the head command if a block is free"""
+        while self.planned and now >= self.block_done:
+            self.planned -= 1
+            self.block_done = self.block_done + self.segment_ms if self.planned else None
+        if not self.queue or self.planned >= self.blocks - 1:
+            return None
+        n, size = self.queue[0]
+        self.planned += 1
+        if self.block_done is None:
+            self.block_done = now + self.segment_ms
+        reply = self.ack(n)
+        self.queue.pop(0)
+        self.used -= size
+        return reply
+
+
+def queue_size(args):
+    """CMD_QUEUE_SIZE"""
+    return args.bufsize * args.max_cmd_size + args.entry_head
+
+
+def simulate(lines, advanced, args):
+    fw = Firmware(queue_size(args), args.max_cmd_size, args.entry_head, args.rx_buffer + 1,
+                  args.blocks, args.segment_ms, args.loop_ms)
+    host = Host(advanced, args.rx_buffer)
+    byte_ms = 10000.0 / args.baud
+    packets = [numbered(l, n).encode() for n, l in enumerate(lines, 1)]
+
+    to_fw, to_host = [], []       # (arrival time, byte)
+    tx_free = rx_free = 0.0       # When each direction of the link is idle
+    reply = ''
+    sent = 0
+    now = 0.0
+    next_loop = 0.0
+    queue_sum = planner_sum = starved = samples = 0
+    while (sent < len(packets) or host.unacked or fw.planned) and not fw.lost:
+        # Host writes what it may
+        while sent < len(packets) and host.may_send(sent + 1, len(packets[sent])):
+            for b in packets[sent]:
+                tx_free = max(tx_free, now) + byte_ms
+                to_fw.append((tx_free, b))
+            host.sent(sent + 1, len(packets[sent]))
+            sent += 1
+        while to_fw and to_fw[0][0] <= now:
+            fw.receive(to_fw.pop(0)[1])
+        while to_host and to_host[0][0] <= now:
+            reply += chr(to_host.pop(0)[1])
+            if reply.endswith('\n'):
+                ok = parse_ok(reply)
+                if ok:
+                    host.ok(ok)
+                reply = ''
+        # Firmware main loop
+        if now >= next_loop:
+            fw.fetch()
+            out = fw.step(now)
+            if out:
+                for b in out.encode():
+                    rx_free = max(rx_free, now) + byte_ms
+                    to_host.append((rx_free, b))
+            next_loop = now + args.loop_ms
+            if sent:
+                queue_sum += len(fw.queue)
+                planner_sum += fw.planned
+                starved += fw.planned == 0 and sent < len(packets)
+                samples += 1
+        now += 0.05
+    samples = max(samples, 1)
+    return now, queue_sum / samples, planner_sum / samples, 100.0 * starved / samples, fw.overflow
+
+
+def loopback(lines, args):
+    ideal = len(lines) * args.segment_ms / 1000.0
+    print('%d segments of %.1fms at %d baud, queue %d bytes, %d planner blocks' % (
+        len(lines), args.segment_ms, args.baud, queue_size(args), args.blocks))
+    print('Moves alone take %.2fs' % ideal)
+    for advanced in (False, True):
+        t, q, p, starved, overflow = simulate(lines, advanced, args)
+        print('%-9s %6.2fs  queue %5.1f cmds  planner %5.1f blocks  starved %5.1f%%  rx overflow %d' % (
+            'advanced' if advanced else 'plain', t / 1000.0, q, p, starved, overflow))
+
+
+def stream(port, lines, rx_buffer):
+    def command(cmd):
+        port.write((cmd + '\n').encode())
+        caps = []
+        while True:
+            r = port.readline().decode(errors='replace').strip()
+            if r.startswith('ok'):
+                return caps
+            if r:
+                caps.append(r)
+
+    if not any('ADVANCED_OK:1' in r for r in command('M115')):
+        print('Firmware has no ADVANCED_OK, waiting for each ok')
+    command('M110 N0')
+
+    host = Host(True, rx_buffer)
+    packets = [numbered(l, n).encode() for n, l in enumerate(lines, 1)]
+    n = 0
+    start = time.time()
+    while n < len(packets) or host.unacked:
+        while n < len(packets) and host.may_send(n + 1, len(packets[n])):
+            port.write(packets[n])
+            host.sent(n + 1, len(packets[n]))
+            n += 1
+        r = port.readline().decode(errors='replace').strip()
+        if not r:
+            continue
+        ok = parse_ok(r)
+        if ok:
+            host.ok(ok)
+        elif r.startswith('Resend:'):
+            n = int(r.split(':')[1]) - 1
+            host.resend(n + 1)
+        else:
+            print(r)
+    elapsed = time.time() - start
+    print('%d lines in %.2fs: %.0f lines/s' % (len(lines), elapsed, len(lines) / elapsed))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Stream G-code to MK4duo with ADVANCED_OK flow control')
+    ap.add_argument('file', nargs='?')
+    ap.add_argument('-p', '--port')
+    ap.add_argument('-b', '--baud', type=int, default=250000)
+    ap.add_argument('--rx-buffer', type=int, default=127, help='firmware RX_BUFFER_SIZE - 1')
+    ap.add_argument('--loopback', action='store_true', help='stream to a model of the firmware')
+    ap.add_argument('--bufsize', type=int, default=4, help='BUFSIZE')
+    ap.add_argument('--max-cmd-size', type=int, default=96, help='MAX_CMD_SIZE')
+    ap.add_argument('--entry-head', type=int, default=3, help='CMD_ENTRY_HEAD, 7 with POWER_LOSS_JOURNAL')
+    ap.add_argument('--blocks', type=int, default=16, help='BLOCK_BUFFER_SIZE')
+    ap.add_argument('--segment-ms', type=float, default=2.0, help='time the planner takes per segment')
+    ap.add_argument('--loop-ms', type=float, default=0.5, help='firmware main loop period')
+    args = ap.parse_args()
+
+    if args.file:
+        with open(args.file) as f:
+            lines = [l for l in (strip(x) for x in f) if l]
+    else:
+        lines = ['G1 X%.3f Y%.3f E%.5f' % (100 + 0.2 * (i % 200), 100 + 0.2 * (i // 200), 0.00665 * (i + 1))
+                 for i in range(2000)]
+
+    if args.loopback:
+        loopback(lines, args)
+    elif args.port:
+        import serial
+        port = serial.Serial(args.port, args.baud, timeout=2)
+        time.sleep(2)  # Boards reset on open
+        port.reset_input_buffer()
+        stream(port, lines, args.rx_buffer)
+    else:
+        ap.error('give --port or --loopback')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,417 @@
+#!/usr/bin/python3
+
+# Host bench of SD_READ_AHEAD against plain SdBaseFile::read
+#
+# A FAT32 card image is written with one G-code file, once in a single
+# run of clusters and once in runs of --run clusters with gaps. SDFat.cpp
+# is built for the host as it is, except Sd2Card, which reads the image
+# and keeps a time model of an SPI card:
+#
+#   command      --cmd-us
+#   first block  --access-us, then 514 bytes at --byte-us
+#   next blocks  --stream-us, then 514 bytes at --byte-us (multi-block read)
+#
+# The reader takes the file a line at a time, as get_sdcard_commands does.
+# "plain" reads with SdBaseFile::read, as without SD_READ_AHEAD. "on demand"
+# fills the read-ahead only when it is empty, "idle" also calls idleFill()
+# after each line, as prefetch() does from idle. For each SD_READ_AHEAD_BLOCKS
+# and image:
+#
+#   bytes/s      file size over the card time spent
+#   line max     longest a line waited for the card, in us
+#   fill max     longest one idleFill() kept the loop, in us
+#   reads        single-block reads (FAT ones in brackets), multi-block
+#                reads and the blocks they took
+#
+# Every byte read is checked against the file written.
+#
+# Run:  bench_sd_read_ahead.py [--blocks 2,4,8] [--idle-blocks 4] [--cluster-kb 32] [--file-kb 1024] [--run 4]
+#
+# The images are sparse files of about 2GB (FAT32 needs 65525 clusters).
+
+import argparse
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SD_DIR = os.path.join(ROOT, 'src', 'sd')
+
+FILE_NAME = 'BENCH.GCO'
+CLUSTERS = 65600
+
+# What SDFat.cpp takes from the firmware, for the host
+BASE_H = r'''
+#ifndef _BENCH_BASE_H_
+#define _BENCH_BASE_H_
+
+#include <ctype.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "@MACROS@"
+
+#define ARDUINO               100
+#define ARDUINO_ARCH_SAM                // 32 bit size_t, as on DUE
+#define PACK                  __attribute__((packed))
+#define SDSUPPORT
+#define HAS_SDSUPPORT         1
+#define HAS_SD_READ_AHEAD     1
+#define SD_READ_AHEAD_BLOCKS  @BLOCKS@
+#define SD_READ_AHEAD_IDLE_BLOCKS @IDLE@
+#define HAS_SD_WRITE_BUFFER   0
+#define SDSS                  0
+#define SD_MAX_FOLDER_DEPTH   5
+#define GCODE_INFO_DIR        "JOBINFO"
+
+typedef const char* PGM_P;
+#define PSTR(s)           (s)
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define strcmp_P          strcmp
+
+#define SERIAL_LMV(...)
+#define SERIAL_LT(...)
+#define SERIAL_LM(...)
+#define SERIAL_ET(...)
+#define SERIAL_EV(...)
+#define SERIAL_TXT(...)
+#define SERIAL_CHR(...)
+#define SERIAL_EOL()
+#define SERIAL_MV(...)
+#define SERIAL_VAL(...)
+
+#define MAX_VFAT_ENTRIES      (2)
+#define FILENAME_LENGTH       13
+#define LONG_FILENAME_LENGTH  (FILENAME_LENGTH * MAX_VFAT_ENTRIES + 1)
+#define SHORT_FILENAME_LENGTH 14
+
+struct CardReader { char fileName[256], tempLongFilename[LONG_FILENAME_LENGTH + 1]; };
+extern CardReader card;
+
+// The card of the bench, see card_model.h
+struct CardModel {
+  FILE*     img;
+  double    cmd_us, access_us, stream_us, byte_us,
+            now_us;                     // Card time spent
+  uint32_t  single_reads, fat_reads, multi_reads, multi_blocks,
+            fat_start, fat_end,         // Blocks of the FATs
+            next_block;
+  bool      first;                      // Next readData is the first of the read
+};
+extern CardModel model;
+
+#endif
+'''
+
+# Sd2Card over the image, in place of the SPI driver
+CARD_MODEL_H = r'''
+CardModel model;
+
+static bool model_read(const uint32_t block, uint8_t* dst) {
+  if (fseeko(model.img, (off_t)block * 512, SEEK_SET)) return false;
+  const size_t n = fread(dst, 1, 512, model.img);
+  memset(dst + n, 0, 512 - n);
+  return true;
+}
+
+static bool model_write(const uint32_t block, const uint8_t* src) {
+  model.now_us += model.access_us + 514 * model.byte_us;
+  return !fseeko(model.img, (off_t)block * 512, SEEK_SET) && fwrite(src, 1, 512, model.img) == 512;
+}
+
+bool Sd2Card::init(uint8_t, uint8_t) { errorCode_ = 0; type(SD_CARD_TYPE_SDHC); return model.img != NULL; }
+bool Sd2Card::setSckRate(uint8_t) { return true; }
+bool Sd2Card::readRegister(uint8_t, void*) { return false; }
+bool Sd2Card::erase(uint32_t, uint32_t) { return true; }
+bool Sd2Card::eraseSingleBlockEnable() { return true; }
+uint32_t Sd2Card::cardSize() { fseeko(model.img, 0, SEEK_END); return ftello(model.img) >> 9; }
+
+bool Sd2Card::readBlock(uint32_t block, uint8_t* dst) {
+  model.now_us += model.cmd_us + model.access_us + 514 * model.byte_us;
+  model.single_reads++;
+  if (block >= model.fat_start && block < model.fat_end) model.fat_reads++;
+  return model_read(block, dst);
+}
+
+bool Sd2Card::readStart(uint32_t block) {
+  model.now_us += model.cmd_us;
+  model.multi_reads++;
+  model.next_block = block;
+  model.first = true;
+  return true;
+}
+
+bool Sd2Card::readData(uint8_t* dst) {
+  model.now_us += (model.first ? model.access_us : model.stream_us) + 514 * model.byte_us;
+  model.first = false;
+  model.multi_blocks++;
+  return model_read(model.next_block++, dst);
+}
+
+bool Sd2Card::readStop() { model.now_us += model.cmd_us; return true; }
+
+bool Sd2Card::writeBlock(uint32_t block, const uint8_t* src) { model.now_us += model.cmd_us; return model_write(block, src); }
+bool Sd2Card::writeStart(uint32_t block, uint32_t) { model.now_us += model.cmd_us; model.next_block = block; return true; }
+bool Sd2Card::writeData(const uint8_t* src) { return model_write(model.next_block++, src); }
+bool Sd2Card::writeStop() { model.now_us += model.cmd_us; return true; }
+'''
+
+MAIN_CPP = r'''
+#include "base.h"
+#include "src/sd/SDFat.h"
+#include <stdlib.h>
+
+CardReader card;
+
+struct Result {
+  double    us, line_max, fill_max;
+  uint32_t  single_reads, fat_reads, multi_reads, multi_blocks, hash;
+};
+
+static void reset_model() {
+  model.now_us = 0;
+  model.single_reads = model.fat_reads = model.multi_reads = model.multi_blocks = 0;
+}
+
+static void take(Result &r) {
+  r.us = model.now_us;
+  r.single_reads = model.single_reads;
+  r.fat_reads = model.fat_reads;
+  r.multi_reads = model.multi_reads;
+  r.multi_blocks = model.multi_blocks;
+}
+
+// FNV-1a of every byte read
+#define HASH(h, c) h = (h ^ (uint8_t)(c)) * 16777619UL
+
+static Result plain(SdBaseFile &file) {
+  Result r = {};
+  file.seekSet(0);
+  reset_model();
+  uint32_t hash = 2166136261UL;
+  for (;;) {
+    const double t0 = model.now_us;
+    int16_t c;
+    while ((c = file.read()) >= 0) { HASH(hash, c); if (c == '\n') break; }
+    if (model.now_us - t0 > r.line_max) r.line_max = model.now_us - t0;
+    if (c < 0) break;
+  }
+  take(r);
+  r.hash = hash;
+  return r;
+}
+
+static Result ahead(SdBaseFile &file, const bool idle) {
+  static SdReadAhead reader;
+  Result r = {};
+  reset_model();
+  if (!reader.start(&file, 0)) { puts("start failed"); exit(1); }
+  // Idle runs before the first line is read
+  if (idle) {
+    if (!reader.idleFill()) { puts("fill failed"); exit(1); }
+    r.fill_max = model.now_us;
+  }
+  uint32_t hash = 2166136261UL;
+  for (;;) {
+    const double t0 = model.now_us;
+    int16_t c;
+    while ((c = reader.read()) >= 0) { HASH(hash, c); if (c == '\n') break; }
+    if (model.now_us - t0 > r.line_max) r.line_max = model.now_us - t0;
+    if (c < 0) break;
+    if (idle) {
+      const double t1 = model.now_us;
+      if (!reader.idleFill()) { puts("fill failed"); exit(1); }
+      if (model.now_us - t1 > r.fill_max) r.fill_max = model.now_us - t1;
+    }
+  }
+  take(r);
+  r.hash = hash;
+  return r;
+}
+
+static bool report(const char* name, const Result &r, const uint32_t size, const uint32_t hash) {
+  printf("  %-16s %9.0f %9.0f %9.0f %7lu (%lu) %5lu %7lu  %s\n", name,
+    size / (r.us / 1e6), r.line_max, r.fill_max,
+    (unsigned long)r.single_reads, (unsigned long)r.fat_reads,
+    (unsigned long)r.multi_reads, (unsigned long)r.multi_blocks,
+    r.hash == hash ? "ok" : "DATA MISMATCH");
+  return r.hash == hash;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 8) { puts("usage: image name hash cmd_us access_us stream_us byte_us"); return 2; }
+  model.img = fopen(argv[1], "r+b");
+  const uint32_t hash = strtoul(argv[3], NULL, 0);
+  model.cmd_us = atof(argv[4]);
+  model.access_us = atof(argv[5]);
+  model.stream_us = atof(argv[6]);
+  model.byte_us = atof(argv[7]);
+
+  static SdFat fat;
+  if (!fat.begin(0, 0)) { puts("volume init failed"); return 1; }
+  model.fat_start = fat.vol()->fatStartBlock();
+  model.fat_end = model.fat_start + 2 * fat.vol()->blocksPerFat();
+
+  static SdBaseFile file;
+  if (!file.open(fat.vwd(), argv[2], O_READ)) { puts("open failed"); return 1; }
+  file.checkContiguous();
+  const uint32_t size = file.fileSize();
+
+  printf("  %-16s %9s %9s %9s %13s %5s %7s\n", "", "bytes/s", "line max", "fill max", "single (FAT)", "multi", "blocks");
+  bool ok = report("plain read", plain(file), size, hash);
+  ok &= report("ahead on demand", ahead(file, false), size, hash);
+  ok &= report("ahead + idle", ahead(file, true), size, hash);
+  return ok ? 0 : 1;
+}
+'''
+
+
+def fnv1a(data):
+    h = 2166136261
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def gcode(size, seed=1):
+    rnd = random.Random(seed)
+    out, n, e = [], 0, 0.0
+    while n < size:
+        e += rnd.uniform(0.01, 0.5)
+        line = 'G1 X%.3f Y%.3f E%.5f\n' % (rnd.uniform(0, 200), rnd.uniform(0, 200), e)
+        if rnd.random() < 0.01:
+            line = 'G1 Z%.2f F9000\n;LAYER:%d\n' % (rnd.uniform(0, 200), len(out))
+        out.append(line)
+        n += len(line)
+    return ''.join(out).encode()[:size]
+
+
+def make_image(path, data, spc, run):
+    """FAT32 image, no MBR, with data as FILE_NAME in the root folder"""
+    reserved, nfats = 32, 2
+    fatsz = ((CLUSTERS + 2) * 4 + 511) // 512
+    data_start = reserved + nfats * fatsz
+    total = data_start + CLUSTERS * spc
+    csize = spc * 512
+
+    boot = bytearray(512)
+    boot[0:3] = b'\xEB\x58\x90'
+    boot[3:11] = b'MSWIN4.1'
+    struct.pack_into('<HBHBHHBHHHII', boot, 11, 512, spc, reserved, nfats, 0, 0, 0xF8, 0, 63, 255, 0, total)
+    struct.pack_into('<IHHIHH', boot, 36, fatsz, 0, 0, 2, 1, 6)
+    struct.pack_into('<BBBI', boot, 64, 0x80, 0, 0x29, 0x12345678)
+    boot[71:82] = b'NO NAME    '
+    boot[82:90] = b'FAT32   '
+    boot[510:512] = b'\x55\xAA'
+
+    fsinfo = bytearray(512)
+    struct.pack_into('<I', fsinfo, 0, 0x41615252)
+    struct.pack_into('<III', fsinfo, 484, 0x61417272, 0xFFFFFFFF, 0xFFFFFFFF)
+    struct.pack_into('<I', fsinfo, 508, 0xAA550000)
+
+    # Clusters of the file, in runs with a free cluster between them
+    count = (len(data) + csize - 1) // csize
+    clusters, c = [], 3
+    while len(clusters) < count:
+        clusters.append(c)
+        c += 1
+        if run and len(clusters) % run == 0:
+            c += 1
+    if c > CLUSTERS + 2:
+        sys.exit('File too large for the image')
+
+    fat = bytearray(fatsz * 512)
+    struct.pack_into('<III', fat, 0, 0x0FFFFFF8, 0x0FFFFFFF, 0x0FFFFFFF)
+    for i, cl in enumerate(clusters):
+        struct.pack_into('<I', fat, cl * 4, clusters[i + 1] if i + 1 < len(clusters) else 0x0FFFFFFF)
+
+    root = bytearray(512)
+    name = FILE_NAME.split('.')
+    root[0:11] = (name[0].ljust(8) + name[1].ljust(3)).encode()
+    root[11] = 0x20
+    struct.pack_into('<H', root, 20, clusters[0] >> 16)
+    struct.pack_into('<HI', root, 26, clusters[0] & 0xFFFF, len(data))
+
+    with open(path, 'wb') as f:
+        f.truncate(total * 512)
+        for sector, block in ((0, boot), (1, fsinfo), (6, boot)):
+            f.seek(sector * 512)
+            f.write(block)
+        for n in range(nfats):
+            f.seek((reserved + n * fatsz) * 512)
+            f.write(fat)
+        f.seek(data_start * 512)
+        f.write(root)
+        for i, cl in enumerate(clusters):
+            f.seek((data_start + (cl - 2) * spc) * 512)
+            f.write(data[i * csize:(i + 1) * csize])
+
+
+def build(tmp, blocks, idle_blocks, cxx):
+    """Host build of SDFat.cpp with the image card, for blocks of read-ahead"""
+    work = os.path.join(tmp, 'b%d' % blocks)
+    os.makedirs(os.path.join(work, 'src', 'sd'))
+    shutil.copy(os.path.join(SD_DIR, 'SDFat.h'), os.path.join(work, 'src', 'sd'))
+    with open(os.path.join(SD_DIR, 'SDFat.cpp')) as f:
+        source = f.read()
+    a = source.index('// ============== Sd2Card.cpp =============')
+    b = source.index('// =================== SdVolume ===================')
+    with open(os.path.join(work, 'src', 'sd', 'SDFat.cpp'), 'w') as f:
+        f.write(source[:a] + '#include "../../card_model.h"\n\n' + source[b:])
+    open(os.path.join(work, 'src', 'sd', 'Arduino.h'), 'w').close()
+    with open(os.path.join(work, 'base.h'), 'w') as f:
+        f.write(BASE_H.replace('@MACROS@', os.path.join(ROOT, 'src', 'macros.h')).replace('@BLOCKS@', str(blocks))
+                .replace('@IDLE@', str(idle_blocks)))
+    with open(os.path.join(work, 'card_model.h'), 'w') as f:
+        f.write(CARD_MODEL_H)
+    with open(os.path.join(work, 'main.cpp'), 'w') as f:
+        f.write(MAIN_CPP)
+    exe = os.path.join(work, 'bench')
+    subprocess.check_call([cxx, '-std=gnu++11', '-O2', '-w', '-fpermissive', '-I', work, '-o', exe,
+                           os.path.join(work, 'main.cpp'), os.path.join(work, 'src', 'sd', 'SDFat.cpp')])
+    return exe
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Bench SD_READ_AHEAD on a card image')
+    ap.add_argument('--blocks', default='2,4,8', help='SD_READ_AHEAD_BLOCKS to build')
+    ap.add_argument('--idle-blocks', type=int, default=4, help='SD_READ_AHEAD_IDLE_BLOCKS')
+    ap.add_argument('--cluster-kb', type=int, default=32, choices=(1, 2, 4, 8, 16, 32))
+    ap.add_argument('--file-kb', type=int, default=1024)
+    ap.add_argument('--run', type=int, default=4, help='clusters in a row of the fragmented file')
+    ap.add_argument('--cmd-us', type=float, default=10)
+    ap.add_argument('--access-us', type=float, default=500, help='card access time of a read')
+    ap.add_argument('--stream-us', type=float, default=20, help='wait between blocks of a multi-block read')
+    ap.add_argument('--byte-us', type=float, default=1.0, help='1.0 is 8MHz SPI')
+    ap.add_argument('--cxx', default='g++')
+    args = ap.parse_args()
+
+    data = gcode(args.file_kb * 1024)
+    expected = '0x%08X' % fnv1a(data)
+    model = [str(v) for v in (args.cmd_us, args.access_us, args.stream_us, args.byte_us)]
+    print('%d KB file, %d KB clusters, card: command %sus, access %sus, stream %sus, %sus/byte'
+          % (args.file_kb, args.cluster_kb, *model))
+
+    ok = True
+    with tempfile.TemporaryDirectory() as tmp:
+        images = (('contiguous', 0), ('runs of %d clusters' % args.run, args.run))
+        for title, run in images:
+            make_image(os.path.join(tmp, '%d.img' % run), data, args.cluster_kb * 2, run)
+        for blocks in (int(b) for b in args.blocks.split(',')):
+            exe = build(tmp, blocks, args.idle_blocks, args.cxx)
+            for title, run in images:
+                print('\nSD_READ_AHEAD_BLOCKS %d, %s' % (blocks, title))
+                sys.stdout.flush()
+                r = subprocess.run([exe, os.path.join(tmp, '%d.img' % run), FILE_NAME, expected] + model)
+                ok = ok and r.returncode == 0
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == '__main__':
+    main()
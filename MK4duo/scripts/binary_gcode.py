@@ -0,0 +1,259 @@
+#!/usr/bin/python3
+
+# Binary G-code encoder and streamer for MK4duo BINARY_GCODE_TRANSPORT
+#
+# Frame, little endian:
+#   0xFE, length (payload bytes), payload, crc16
+#   payload: sequence (uint16), letter, code (uint16),
+#            params (uint32, bit 0 = A ... bit 25 = Z),
+#            ints (uint32, params sent as int32 rather than float),
+#            one 4 byte value per param in A-Z order, float NaN = no value
+#   crc: CRC-16/CCITT-FALSE over the length and payload bytes
+#
+# The sequence is the line number shared with N of ASCII lines, so lines
+# that can't be encoded (M23, M117...) are sent as checksummed ASCII.
+#
+# Stream a file:      binary_gcode.py -p /dev/ttyACM0 -b 250000 file.gcode
+# Same, ASCII only:   binary_gcode.py -p /dev/ttyACM0 -b 250000 --ascii file.gcode
+# Check the encoder:  binary_gcode.py --loopback file.gcode
+#
+# Needs pyserial for -p.
+
+import argparse
+import math
+import re
+import struct
+import sys
+import time
+
+SYNC = 0xFE
+STRING_CODES = {('M', 23), ('M', 28), ('M', 30), ('M', 32), ('M', 36), ('M', 117), ('M', 118), ('M', 577), ('M', 928)}
+WORD = re.compile(r'([A-Z])\s*([-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?)?')
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def strip(line):
+    return line.split(';', 1)[0].strip()
+
+
+def parse(line):
+    """Split a line into letter, code and {param: value}, None if it can't be binary"""
+    line = strip(line).upper()
+    m = re.match(r'([GMT])\s*(\d+)(.*)$', line)
+    if not m:
+        return None
+    letter, code, rest = m.group(1), int(m.group(2)), m.group(3)
+    if (letter, code) in STRING_CODES or code > 0xFFFF:
+        return None
+    params = {}
+    pos = 0
+    rest = rest.strip()
+    while pos < len(rest):
+        if rest[pos] == ' ':
+            pos += 1
+            continue
+        w = WORD.match(rest, pos)
+        if not w or w.group(1) in params:
+            return None
+        value = w.group(2)
+        if value is None:
+            params[w.group(1)] = None
+        elif re.match(r'^[-+]?\d+$', value) and -2**31 <= int(value) < 2**31:
+            params[w.group(1)] = int(value)
+        else:
+            params[w.group(1)] = float(value)
+        pos = w.end()
+    return letter, code, params
+
+
+def encode(line, seq, max_cmd_size=96):
+    """Binary frame for a line, or None to send it as ASCII"""
+    p = parse(line)
+    if p is None:
+        return None
+    letter, code, params = p
+    mask = ints = 0
+    values = b''
+    for k in sorted(params):
+        bit = ord(k) - ord('A')
+        mask |= 1 << bit
+        v = params[k]
+        if isinstance(v, int):
+            ints |= 1 << bit
+            values += struct.pack('<i', v)
+        else:
+            values += struct.pack('<f', float('nan') if v is None else v)
+    payload = struct.pack('<HcHII', seq & 0xFFFF, letter.encode(), code, mask, ints) + values
+    if len(payload) > max_cmd_size - 2:
+        return None
+    body = bytes([len(payload)]) + payload
+    return bytes([SYNC]) + body + struct.pack('<H', crc16(body))
+
+
+def decode(frame):
+    """Inverse of encode, for the loopback check"""
+    if frame[0] != SYNC or len(frame) != frame[1] + 4:
+        raise ValueError('bad frame length')
+    body = frame[1:-2]
+    if crc16(body) != struct.unpack('<H', frame[-2:])[0]:
+        raise ValueError('bad crc')
+    seq, letter, code, mask, ints = struct.unpack('<HcHII', body[1:14])
+    params, off = {}, 14
+    for bit in range(26):
+        if mask >> bit & 1:
+            raw = body[off:off + 4]
+            if ints >> bit & 1:
+                params[chr(65 + bit)] = struct.unpack('<i', raw)[0]
+            else:
+                f = struct.unpack('<f', raw)[0]
+                params[chr(65 + bit)] = None if math.isnan(f) else f
+            off += 4
+    return seq, letter.decode(), code, params
+
+
+def ascii_line(line, seq):
+    cmd = 'N%d %s' % (seq, strip(line))
+    cs = 0
+    for c in cmd.encode():
+        cs ^= c
+    return ('%s*%d\n' % (cmd, cs)).encode()
+
+
+def read_lines(path):
+    with open(path) as f:
+        return [l for l in (strip(x) for x in f) if l]
+
+
+class MemoryLoop:
+    """Stand-in for pyserial loop:// when pyserial is missing"""
+    def __init__(self):
+        self.buf = bytearray()
+
+    def write(self, data):
+        self.buf += data
+
+    def read(self, size):
+        data, self.buf = bytes(self.buf[:size]), self.buf[size:]
+        return data
+
+
+def loopback(lines):
+    try:
+        import serial
+        port = serial.serial_for_url('loop://', timeout=1)
+    except ImportError:
+        port = MemoryLoop()
+    text_bytes = bin_bytes = binary = 0
+    start = time.time()
+    for n, line in enumerate(lines, 1):
+        text_bytes += len(ascii_line(line, n))
+        frame = encode(line, n)
+        if frame is None:
+            bin_bytes += len(ascii_line(line, n))
+            continue
+        port.write(frame)
+        back = port.read(len(frame))
+        seq, letter, code, params = decode(back)
+        want = parse(line)
+        if seq != n or (letter, code) != want[:2] or set(params) != set(want[2]):
+            sys.exit('Mismatch at line %d: %s' % (n, line))
+        for k, v in want[2].items():
+            if v is None or isinstance(v, int):
+                ok = params[k] == v
+            else:
+                ok = abs(params[k] - v) <= abs(v) * 1e-6 + 1e-6
+            if not ok:
+                sys.exit('Value mismatch at line %d: %s' % (n, line))
+        bin_bytes += len(frame)
+        binary += 1
+    elapsed = time.time() - start
+    print('%d lines, %d binary, round trip ok in %.2fs' % (len(lines), binary, elapsed))
+    print('ASCII  %d bytes, %.1f per line' % (text_bytes, text_bytes / max(len(lines), 1)))
+    print('Binary %d bytes, %.1f per line' % (bin_bytes, bin_bytes / max(len(lines), 1)))
+    for baud in (115200, 250000):
+        print('At %d baud: ASCII %.0f lines/s, binary %.0f lines/s' % (
+            baud, baud / 10.0 * len(lines) / max(text_bytes, 1), baud / 10.0 * len(lines) / max(bin_bytes, 1)))
+
+
+def stream(port, lines, use_binary, rx_buffer):
+    """Keep at most rx_buffer bytes unacknowledged, resend from the line asked for"""
+    def send_ascii(cmd):
+        port.write((cmd + '\n').encode())
+        while True:
+            r = port.readline().decode(errors='replace').strip()
+            if r.startswith('ok'):
+                return
+            if r:
+                print(r)
+
+    send_ascii('M110 N0')
+    if use_binary:
+        send_ascii('M575 S1')
+
+    packets = [None] * (len(lines) + 1)
+    for n, line in enumerate(lines, 1):
+        frame = encode(line, n) if use_binary else None
+        packets[n] = frame if frame is not None else ascii_line(line, n)
+
+    inflight = []
+    n = 1
+    start = time.time()
+    sent = 0
+    while n <= len(lines) or inflight:
+        while n <= len(lines) and sum(len(packets[i]) for i in inflight) + len(packets[n]) <= rx_buffer:
+            port.write(packets[n])
+            sent += len(packets[n])
+            inflight.append(n)
+            n += 1
+        r = port.readline().decode(errors='replace').strip()
+        if not r:
+            continue
+        if r.startswith('Resend:'):
+            # Lines from n on were dropped, earlier ones are still acknowledged
+            n = int(r.split(':')[1])
+            inflight = [i for i in inflight if i < n]
+        elif r.startswith('ok'):
+            if inflight:
+                inflight.pop(0)
+        else:
+            print(r)
+    elapsed = time.time() - start
+
+    if use_binary:
+        send_ascii('M575 S0')
+    print('%d lines, %d bytes in %.2fs: %.0f lines/s' % (len(lines), sent, elapsed, len(lines) / elapsed))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Stream G-code to MK4duo as binary frames')
+    ap.add_argument('file')
+    ap.add_argument('-p', '--port')
+    ap.add_argument('-b', '--baud', type=int, default=250000)
+    ap.add_argument('--ascii', action='store_true', help='send checksummed ASCII lines only, for comparison')
+    ap.add_argument('--rx-buffer', type=int, default=127, help='firmware RX_BUFFER_SIZE - 1')
+    ap.add_argument('--loopback', action='store_true', help='encode, send through loop:// and decode')
+    args = ap.parse_args()
+
+    lines = read_lines(args.file)
+    if args.loopback:
+        loopback(lines)
+    elif args.port:
+        import serial
+        port = serial.Serial(args.port, args.baud, timeout=2)
+        time.sleep(2)  # Boards reset on open
+        port.reset_input_buffer()
+        stream(port, lines, not args.ascii, args.rx_buffer)
+    else:
+        ap.error('give --port or --loopback')
+
+
+if __name__ == '__main__':
+    main()
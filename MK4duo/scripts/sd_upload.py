@@ -0,0 +1,234 @@
+#!/usr/bin/python3
+
+# Binary file upload to the SD card of MK4duo with SD_BINARY_UPLOAD
+#
+#   M577 S<bytes> <filename>
+#
+# allocates the file contiguous for its size, then the host sends it in
+# frames, little endian:
+#   0xFD, sequence (uint16), 512 bytes of the file, crc16
+#   crc: CRC-16/CCITT-FALSE over the sequence and data bytes
+#   the last chunk is padded to 512 bytes
+#
+# Each frame is answered with "Upload ok:<seq>" or "Upload resend:<seq>",
+# and the host sends the next one only then. After the last chunk the
+# firmware closes the file and prints "File saved".
+#
+# Upload a file:      sd_upload.py -p /dev/ttyACM0 -b 250000 file.gcode [NAME.GCO]
+# Simulate:           sd_upload.py --loopback [file.gcode]
+#
+# --loopback sends the file to a model of the firmware receiver through a
+# link that corrupts and drops bytes and loses answers, checks the file
+# it gets back and prints the time the upload would take at the baud
+# rate. Without a file it sends 64KB of random bytes. Needs pyserial for -p.
+
+import argparse
+import os
+import random
+import struct
+import sys
+import time
+
+SYNC = 0xFD
+CHUNK = 512
+FRAME_SIZE = 1 + 2 + CHUNK + 2
+BYTE_TIMEOUT = 0.2
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+def frames(data):
+    """One frame per 512 byte chunk of data"""
+    out = []
+    for seq, pos in enumerate(range(0, len(data), CHUNK)):
+        body = struct.pack('<H', seq & 0xFFFF) + data[pos:pos + CHUNK].ljust(CHUNK, b'\0')
+        out.append(bytes([SYNC]) + body + struct.pack('<H', crc16(body)))
+    return out
+
+
+def parse_reply(reply):
+    """('ok' or 'resend', seq) of an upload answer, None for other lines"""
+    for kind in ('ok', 'resend'):
+        tag = 'Upload %s:' % kind
+        if reply.startswith(tag):
+            return kind, int(reply[len(tag):])
+    return None
+
+
+class Receiver:
+    """CardReader::uploadByte and uploadChunk, writing to a bytearray"""
+    def __init__(self, size):
+        self.blocks = (size + CHUNK - 1) // CHUNK
+        self.size = size
+        self.card = bytearray()
+        self.next = 0
+        self.frame = bytearray()
+        self.done = False
+
+    def byte(self, c):
+        if not self.frame and c != SYNC:
+            return None
+        self.frame.append(c)
+        if len(self.frame) < FRAME_SIZE:
+            return None
+        body, crc = bytes(self.frame[1:-2]), struct.unpack('<H', self.frame[-2:])[0]
+        self.frame = bytearray()
+        seq = struct.unpack('<H', body[:2])[0]
+        if crc16(body) != crc:
+            return self.reply('resend', self.next)
+        if self.next and seq == (self.next - 1) & 0xFFFF:
+            return self.reply('ok', seq)
+        if seq != self.next & 0xFFFF:
+            return self.reply('resend', self.next)
+        self.card += body[2:]
+        self.next += 1
+        if self.next == self.blocks:
+            self.done = True
+        return self.reply('ok', seq)
+
+    def timeout(self):
+        """A frame stopped arriving"""
+        if self.frame:
+            self.frame = bytearray()
+            return self.reply('resend', self.next)
+        return None
+
+    def reply(self, kind, seq):
+        return 'Upload %s:%d' % (kind, seq)
+
+    def file(self):
+        return bytes(self.card[:self.size])
+
+
+def loopback(data, args):
+    rnd = random.Random(args.seed)
+    rx = Receiver(len(data))
+    packets = frames(data)
+    byte_s = 10.0 / args.baud
+    reply_s = 20 * byte_s + args.write_ms / 1000.0
+    now = 0.0
+    sent = corrupted = dropped = lost = resent = 0
+    n = 0
+    while not rx.done:
+        frame = bytearray(packets[n])
+        if rnd.random() < args.error_rate:
+            frame[rnd.randrange(len(frame))] ^= 1 << rnd.randrange(8)
+            corrupted += 1
+        if rnd.random() < args.error_rate:
+            del frame[rnd.randrange(len(frame))]
+            dropped += 1
+        now += len(frame) * byte_s
+        sent += len(frame)
+        answer = None
+        for b in frame:
+            answer = rx.byte(b) or answer
+        if answer is None:
+            now += BYTE_TIMEOUT
+            answer = rx.timeout()
+        now += reply_s
+        if rnd.random() < args.error_rate:
+            # The answer never arrives, the host sends the frame again
+            lost += 1
+            now += args.host_timeout
+            continue
+        kind, seq = parse_reply(answer)
+        if kind == 'ok' and seq == n:
+            n += 1
+        else:
+            n = seq
+            resent += 1
+    if rx.file() != data:
+        sys.exit('Uploaded file differs')
+    ideal = len(packets) * (FRAME_SIZE * byte_s + reply_s)
+    print('%d bytes in %d chunks, file ok' % (len(data), len(packets)))
+    print('%d frame bytes, %d corrupted, %d cut, %d answers lost, %d resends' % (
+        sent, corrupted, dropped, lost, resent))
+    print('At %d baud: %.2fs, %.0f bytes/s (%.2fs, %.0f bytes/s without errors)' % (
+        args.baud, now, len(data) / now, ideal, len(data) / ideal))
+
+
+def upload(port, data, name):
+    def command(cmd):
+        port.write((cmd + '\n').encode())
+        while True:
+            r = port.readline().decode(errors='replace').strip()
+            if r.startswith('ok'):
+                return
+            if r.startswith('Error'):
+                sys.exit(r)
+            if r:
+                print(r)
+
+    command('M577 S%d %s' % (len(data), name))
+    packets = frames(data)
+    n = 0
+    start = time.time()
+    while n < len(packets):
+        port.write(packets[n])
+        while True:
+            r = port.readline().decode(errors='replace').strip()
+            if not r:
+                break                       # Lost answer, send the frame again
+            reply = parse_reply(r)
+            if reply:
+                kind, seq = reply
+                if kind == 'ok' and seq == n & 0xFFFF:
+                    n += 1
+                elif kind == 'resend':
+                    n += ((seq - n + 0x8000) & 0xFFFF) - 0x8000
+                break
+            if r.startswith('Error'):
+                sys.exit(r)
+            print(r)
+        sys.stdout.write('\r%d/%d' % (n, len(packets)))
+        sys.stdout.flush()
+    while True:
+        r = port.readline().decode(errors='replace').strip()
+        if r:
+            print('\n' + r)
+        if not r or 'File saved' in r or r.startswith('Error'):
+            break
+    elapsed = time.time() - start
+    print('%d bytes in %.2fs: %.0f bytes/s' % (len(data), elapsed, len(data) / elapsed))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Upload a file to the SD card of MK4duo with M577')
+    ap.add_argument('file', nargs='?')
+    ap.add_argument('name', nargs='?', help='name on the card, 8.3, default the file name')
+    ap.add_argument('-p', '--port')
+    ap.add_argument('-b', '--baud', type=int, default=250000)
+    ap.add_argument('--loopback', action='store_true', help='upload to a model of the firmware')
+    ap.add_argument('--error-rate', type=float, default=0.02, help='chance of each link error per frame')
+    ap.add_argument('--write-ms', type=float, default=1.0, help='time the card takes per block')
+    ap.add_argument('--host-timeout', type=float, default=1.0, help='seconds before a lost answer is resent')
+    ap.add_argument('--seed', type=int, default=1)
+    args = ap.parse_args()
+
+    if args.file:
+        with open(args.file, 'rb') as f:
+            data = f.read()
+    else:
+        data = bytes(random.Random(args.seed).getrandbits(8) for _ in range(65536))
+
+    if args.loopback:
+        loopback(data, args)
+    elif args.port and args.file:
+        import serial
+        port = serial.Serial(args.port, args.baud, timeout=2)
+        time.sleep(2)  # Boards reset on open
+        port.reset_input_buffer()
+        upload(port, data, (args.name or os.path.basename(args.file)).upper())
+    else:
+        ap.error('give --port and a file, or --loopback')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,170 @@
+#!/usr/bin/python3
+
+# Host test of GCodeParser::parse_float and parse_long against strtod
+#
+# The two functions are taken as they are from src/commands/parser.cpp,
+# built for the host with g++ and run over fixed cases (zero, signs, many
+# digits, values past 24 and 32 bits, exponents, which the G-code grammar
+# stops at) and random values compared with strtof of the same text.
+#
+# Run:  test_parse_float.py [-n 2000000] [--cxx g++]
+#
+# Values with up to 9 fraction digits must match strtof exactly, longer
+# fractions within one float step (the parser keeps 9 digits) and integer
+# parts past 32 bits within a few steps (they are scaled by 10 as floats).
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+PARSER = os.path.join(ROOT, 'src', 'commands', 'parser.cpp')
+
+HARNESS = r'''
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define WITHIN(V, L, H) ((V) >= (L) && (V) <= (H))
+#define NUMERIC(a)      WITHIN(a, '0', '9')
+
+struct GCodeParser {
+  static float parse_float(const char *p, char **end = NULL);
+  static int32_t parse_long(const char *p, char **end = NULL);
+};
+
+%(code)s
+
+static unsigned long failed = 0;
+
+// The G-code grammar: [spaces][+-]digits[.digits], no exponent
+static size_t grammar_end(const char *s) {
+  const char *p = s;
+  while (*p == ' ') p++;
+  if (*p == '-' || *p == '+') p++;
+  bool digits = false, point = false;
+  for (;; p++) {
+    if (*p == '.' && !point) { point = true; continue; }
+    if (!NUMERIC(*p)) break;
+    digits = true;
+  }
+  return digits ? p - s : 0;
+}
+
+static unsigned fraction_digits(const char *s, size_t n) {
+  const char *dot = (const char*)memchr(s, '.', n);
+  return dot ? (unsigned)(s + n - dot - 1) : 0;
+}
+
+static bool integer_fits(const char *s) {
+  return fabs(strtod(s, NULL)) < 4294967296.0;
+}
+
+static void check_float(const char *s) {
+  char *end;
+  const float v = GCodeParser::parse_float(s, &end);
+  const size_t n = grammar_end(s);
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%%.*s", (int)n, s);
+  const float want = n ? strtof(prefix, NULL) : 0.0f;
+  bool ok = (size_t)(end - s) == n;
+  if (!integer_fits(prefix))
+    ok = ok && fabsf(v - want) <= fabsf(want) * 1e-6f;
+  else if (fraction_digits(s, n) <= 9)
+    ok = ok && (v == want) && (std::signbit(v) == std::signbit(want) || !n);
+  else
+    ok = ok && fabsf(v - want) <= fabsf(nextafterf(want, INFINITY) - want) + 1e-9f;
+  if (!ok) {
+    if (++failed <= 20) printf("parse_float(\"%%s\") = %%.9g end %%d, strtof %%.9g end %%d\n", s, v, (int)(end - s), want, (int)n);
+  }
+}
+
+static void check_long(const char *s) {
+  char *end, *want_end;
+  const int32_t v = GCodeParser::parse_long(s, &end);
+  const long want = strtol(s, &want_end, 10);
+  if (v != (int32_t)want || end != want_end) {
+    if (++failed <= 20) printf("parse_long(\"%%s\") = %%ld end %%d, strtol %%ld end %%d\n", s, (long)v, (int)(end - s), want, (int)(want_end - s));
+  }
+}
+
+static uint64_t rng = 88172645463325252ULL;
+static uint32_t next() { rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17; return (uint32_t)rng; }
+
+int main(int argc, char **argv) {
+  static const char * const cases[] = {
+    "0", "-0", "+0", "0.", ".0", "0.0", "-0.0", "0.00000000", "-0.00000000",
+    "0.000000000", "0.0000000000000", "000000.000000", " 0.00000000",
+    "1", "-1", "+1", "1.5", "-1.5", ".5", "-.5", "5.", "  12.25",
+    "0.1", "0.2", "0.3", "0.123456789", "0.000000001", "0.999999999",
+    "123.456789012", "1.23456789012345", "0.00000000012", "3.14159265358979",
+    "16777215", "16777216", "16777217", "16777218.5", "33554431.999999999",
+    "4294967295", "4294967296", "99999999999", "12345678901234567890",
+    "1e5", "2.5E-3", "-7e", "1.0e+10", "3E2",
+    "", "-", "+", ".", "-.", "X1", "1.2.3", "12abc", "0x10",
+  };
+  for (const char *s : cases) check_float(s);
+
+  static const char * const longs[] = { "0", "-0", "17", "-17", "+5", "  42", "2147483647", "-2147483648", "12abc", "", "-", "x" };
+  for (const char *s : longs) check_long(s);
+
+  const unsigned long count = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000UL;
+  char buf[48];
+  for (unsigned long i = 0; i < count; i++) {
+    const unsigned ilen = next() %% 10, flen = next() %% 12;
+    char *p = buf;
+    if (next() & 1) *p++ = '-';
+    for (unsigned k = 0; k < ilen; k++) *p++ = '0' + next() %% 10;
+    if (flen || !ilen) {
+      *p++ = '.';
+      for (unsigned k = 0; k < flen; k++) *p++ = '0' + (next() %% 4 ? next() %% 10 : 0);
+      if (!ilen && !flen) *p++ = '0';
+    }
+    *p = '\0';
+    check_float(buf);
+  }
+
+  printf("%%lu random values and %%u fixed cases, %%lu failed\n", count, (unsigned)(sizeof(cases) / sizeof(*cases) + sizeof(longs) / sizeof(*longs)), failed);
+  return failed ? 1 : 0;
+}
+'''
+
+
+def extract(source, signature):
+    """The function starting with signature, up to its closing brace"""
+    start = source.index(signature)
+    end = re.compile(r'^}\s*$', re.M).search(source, start).end()
+    return source[start:end]
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Test parse_float and parse_long against strtod')
+    ap.add_argument('-n', type=int, default=2000000, help='random values to check')
+    ap.add_argument('--cxx', default='g++')
+    args = ap.parse_args()
+
+    with open(PARSER) as f:
+        source = f.read()
+    code = extract(source, 'float GCodeParser::parse_float(') + '\n\n' + extract(source, 'int32_t GCodeParser::parse_long(')
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = os.path.join(tmp, 'parse_float_test.cpp')
+        exe = os.path.join(tmp, 'parse_float_test')
+        with open(src, 'w') as f:
+            f.write(HARNESS % {'code': code})
+        subprocess.check_call([args.cxx, '-std=c++11', '-O2', '-Wall', '-o', exe, src])
+        # Time out rather than hang on a value the parser loops on
+        try:
+            r = subprocess.run([exe, str(args.n)], timeout=300)
+        except subprocess.TimeoutExpired:
+            sys.exit('parse_float_test did not end')
+        sys.exit(r.returncode)
+
+
+if __name__ == '__main__':
+    main()
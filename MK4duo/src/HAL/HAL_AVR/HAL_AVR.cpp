@@ -111,6 +111,10 @@ void HAL_temp_timer_start() {
 
 bool HAL::execute_100ms = false;
 
+#if NUM_SERIAL > 1
+  int8_t HAL::serial_port = -1;
+#endif
+
 // Return available memory
 int HAL::getFreeRam() {
   int freeram = 0;
@@ -96,8 +96,26 @@ typedef int8_t    Pin;
 #ifndef EXTERNALSERIAL
   #include "HardwareSerial.h"
   #define MKSERIAL MKSerial
+  #define HAS_SERIAL_TX_STATS (TX_BUFFER_SIZE > 0)
 #else
   #define MKSERIAL Serial
+  #define HAS_SERIAL_TX_STATS false
+#endif
+
+// Second host port, always the arduino serial
+#if ENABLED(SERIAL_PORT_2)
+  #if SERIAL_PORT_2 == 0
+    #define MKSERIAL2 Serial
+  #elif SERIAL_PORT_2 == 1
+    #define MKSERIAL2 Serial1
+  #elif SERIAL_PORT_2 == 2
+    #define MKSERIAL2 Serial2
+  #elif SERIAL_PORT_2 == 3
+    #define MKSERIAL2 Serial3
+  #endif
+  #define NUM_SERIAL 2
+#else
+  #define NUM_SERIAL 1
 #endif
 
 // --------------------------------------------------------------------------
@@ -370,6 +388,10 @@ class HAL {
 
     static bool execute_100ms;
 
+    #if NUM_SERIAL > 1
+      static int8_t serial_port;  // Port written by serialWriteByte and SERIAL_OUT, -1 = all
+    #endif
+
   public: /** Public Function */
 
     // do any hardware-specific initialization here
@@ -407,19 +429,37 @@ class HAL {
       return millis();
     }
 
-    static inline void serialSetBaudrate(const uint16_t baud) {
+    static inline void serialSetBaudrate(const long baud) {
       MKSERIAL.begin(baud);
+      #if NUM_SERIAL > 1
+        MKSERIAL2.begin(baud);
+      #endif
     }
-    static inline bool serialByteAvailable() {
+    static inline bool serialByteAvailable(const uint8_t port=0) {
+      #if NUM_SERIAL > 1
+        if (port) return MKSERIAL2.available() > 0;
+      #endif
       return MKSERIAL.available() > 0;
     }
-    static inline uint8_t serialReadByte() {
+    static inline uint8_t serialReadByte(const uint8_t port=0) {
+      #if NUM_SERIAL > 1
+        if (port) return MKSERIAL2.read();
+      #endif
       return MKSERIAL.read();
     }
     static inline void serialWriteByte(const char b) {
-      MKSERIAL.write(b);
+      #if NUM_SERIAL > 1
+        if (serial_port != 1) MKSERIAL.write(b);
+        if (serial_port != 0) MKSERIAL2.write(b);
+      #else
+        MKSERIAL.write(b);
+      #endif
     }
-    static inline void serialFlush() {
+    static inline void serialFlush(const uint8_t port=0) {
+      #if NUM_SERIAL > 1
+        // The arduino flush waits for TX, drop the received bytes
+        if (port) { while (MKSERIAL2.read() >= 0) { /* nada */ } return; }
+      #endif
       MKSERIAL.flush();
     }
 
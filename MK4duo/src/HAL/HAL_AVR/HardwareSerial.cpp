@@ -76,6 +76,10 @@
     ring_buffer_pos_t rx_max_enqueued = 0;
   #endif
 
+  #if TX_BUFFER_SIZE > 0
+    uint32_t tx_stalls = 0, tx_stall_us = 0;
+  #endif
+
   #if ENABLED(EMERGENCY_PARSER)
 
     // Currently looking for: M108, M112, M410
@@ -438,18 +442,23 @@
 
       // If the output buffer is full, there's nothing for it other than to
       // wait for the interrupt handler to empty it a bit
-      while (i == tx_buffer.tail) {
-        if (!TEST(SREG, SREG_I)) {
-          // Interrupts are disabled, so we'll have to poll the data
-          // register empty flag ourselves. If it is set, pretend an
-          // interrupt has happened and call the handler to free up
-          // space for us.
-          if (TEST(M_UCSRxA, M_UDREx))
-            _tx_udr_empty_irq();
-        }
-        else {
-          // nop, the interrupt handler will free up space for us
+      if (i == tx_buffer.tail) {
+        const uint32_t stall_start = micros();
+        while (i == tx_buffer.tail) {
+          if (!TEST(SREG, SREG_I)) {
+            // Interrupts are disabled, so we'll have to poll the data
+            // register empty flag ourselves. If it is set, pretend an
+            // interrupt has happened and call the handler to free up
+            // space for us.
+            if (TEST(M_UCSRxA, M_UDREx))
+              _tx_udr_empty_irq();
+          }
+          else {
+            // nop, the interrupt handler will free up space for us
+          }
         }
+        tx_stalls++;
+        tx_stall_us += micros() - stall_start;
       }
 
       tx_buffer.buffer[tx_buffer.head] = c;
@@ -461,6 +470,40 @@
       return;
     }
 
+    /**
+     * Copy as much of the buffer as fits into the TX ring at once,
+     * the interrupt sends it. Only a full ring falls back to the
+     * byte by byte write, which waits.
+     */
+    void MKHardwareSerial::write(const uint8_t* buffer, size_t size) {
+      #if ENABLED(SERIAL_XON_XOFF)
+        // XON/XOFF may have to go in between, byte by byte
+        while (size--) write(*buffer++);
+      #else
+        while (size) {
+          CRITICAL_SECTION_START;
+            const uint8_t h = tx_buffer.head,
+                          t = tx_buffer.tail;
+          CRITICAL_SECTION_END;
+          uint8_t room = (uint8_t)(t - h - 1) & (TX_BUFFER_SIZE - 1);
+          if (!room) {
+            writeNoHandshake(*buffer++);
+            size--;
+            continue;
+          }
+          NOMORE(room, size);
+          for (uint8_t i = 0; i < room; i++)
+            tx_buffer.buffer[(uint8_t)(h + i) & (TX_BUFFER_SIZE - 1)] = *buffer++;
+          size -= room;
+          _written = true;
+          CRITICAL_SECTION_START;
+            tx_buffer.head = (uint8_t)(h + room) & (TX_BUFFER_SIZE - 1);
+            SBI(M_UCSRxB, M_UDRIEx);
+          CRITICAL_SECTION_END;
+        }
+      #endif
+    }
+
     void MKHardwareSerial::flushTX(void) {
       // TX
       // If we have never written a byte, no need to flush. This special
@@ -600,7 +643,11 @@
   // Private Methods
 
   void MKHardwareSerial::printNumber(unsigned long n, uint8_t base) {
-    if (n) {
+    if (base == 10) {
+      char buf[NUMBER_STR_SIZE];
+      write((const uint8_t*)buf, ultostr(buf, n));
+    }
+    else if (n) {
       unsigned char buf[8 * sizeof(long)]; // Enough space for base 2
       int8_t i = 0;
       while (n) {
@@ -614,36 +661,10 @@
       print('0');
   }
 
+  // Formatted in integer math, then queued in one go
   void MKHardwareSerial::printFloat(double number, uint8_t digits) {
-    // Handle negative numbers
-    if (number < 0.0) {
-      print('-');
-      number = -number;
-    }
-
-    // Round correctly so that print(1.999, 2) prints as "2.00"
-    double rounding = 0.5;
-    for (uint8_t i = 0; i < digits; ++i)
-      rounding *= 0.1;
-
-    number += rounding;
-
-    // Extract the integer part of the number and print it
-    unsigned long int_part = (unsigned long)number;
-    double remainder = number - (double)int_part;
-    print(int_part);
-
-    // Print the decimal point, but only if there are digits beyond
-    if (digits) {
-      print('.');
-      // Extract digits from the remainder one at a time
-      while (digits--) {
-        remainder *= 10.0;
-        int toPrint = int(remainder);
-        print(toPrint);
-        remainder -= toPrint;
-      }
-    }
+    char buf[NUMBER_STR_SIZE];
+    write((const uint8_t*)buf, ftostrn(buf, number, digits));
   }
 
   // Preinstantiate Objects
@@ -127,6 +127,11 @@
   extern ring_buffer_pos_t rx_max_enqueued;
 #endif
 
+#if TX_BUFFER_SIZE > 0
+  extern uint32_t tx_stalls,    // Writes that waited for room in the TX buffer
+                  tx_stall_us;  // Time spent waiting
+#endif
+
 class MKHardwareSerial { //: public Stream
 
   public: /** Constructor */
@@ -146,6 +151,12 @@ class MKHardwareSerial { //: public Stream
     #if TX_BUFFER_SIZE > 0
       static uint8_t availableForWrite(void);
       static void flushTX(void);
+      static void write(const uint8_t* buffer, size_t size);
+      FORCE_INLINE static uint32_t txStalls() { return tx_stalls; }
+      FORCE_INLINE static uint32_t txStallMicros() { return tx_stall_us; }
+      FORCE_INLINE static void txStatsReset() { tx_stalls = tx_stall_us = 0; }
+    #else
+      static FORCE_INLINE void write(const uint8_t* buffer, size_t size) { while (size--) write(*buffer++); }
     #endif
     static void writeNoHandshake(const uint8_t c);
 
@@ -157,8 +168,7 @@ class MKHardwareSerial { //: public Stream
       FORCE_INLINE static ring_buffer_pos_t rxMaxEnqueued() { return rx_max_enqueued; }
     #endif
 
-    static FORCE_INLINE void write(const char* str) { while (*str) write(*str++); }
-    static FORCE_INLINE void write(const uint8_t* buffer, size_t size) { while (size--) write(*buffer++); }
+    static FORCE_INLINE void write(const char* str) { write((const uint8_t*)str, strlen(str)); }
     static FORCE_INLINE void print(const String& s) { for (int i = 0; i < (int)s.length(); i++) write(s[i]); }
     static FORCE_INLINE void print(const char* str) { write(str); }
 
@@ -28,22 +28,34 @@ uint8_t mk_debug_flags = DEBUG_NONE;
 
 // Things to write to serial from Program memory. Saves 400 to 2k of RAM.
 void serialprintPGM(const char* str) {
-  while (char ch = pgm_read_byte(str++)) MKSERIAL.write(ch);
+  while (char ch = pgm_read_byte(str++)) HAL::serialWriteByte(ch);
 }
 
-void serial_print_pair(const char* msg, const char *v)   { serialprintPGM(msg); MKSERIAL.print(v); }
-void serial_print_pair(const char* msg, char v)          { serialprintPGM(msg); MKSERIAL.print(v); }
-void serial_print_pair(const char* msg, int v)           { serialprintPGM(msg); MKSERIAL.print(v); }
-void serial_print_pair(const char* msg, long v)          { serialprintPGM(msg); MKSERIAL.print(v); }
-void serial_print_pair(const char* msg, float v, int n)  { serialprintPGM(msg); MKSERIAL.print(v, n); }
-void serial_print_pair(const char* msg, double v)        { serialprintPGM(msg); MKSERIAL.print(v); }
+void serial_print_pair(const char* msg, const char *v)   { serialprintPGM(msg); SERIAL_OUT(print, v); }
+void serial_print_pair(const char* msg, char v)          { serialprintPGM(msg); SERIAL_OUT(print, v); }
+void serial_print_pair(const char* msg, int v)           { serialprintPGM(msg); SERIAL_OUT(print, v); }
+void serial_print_pair(const char* msg, long v)          { serialprintPGM(msg); SERIAL_OUT(print, v); }
+void serial_print_pair(const char* msg, float v, int n)  { serialprintPGM(msg); SERIAL_OUT(print, v, n); }
+void serial_print_pair(const char* msg, double v)        { serialprintPGM(msg); SERIAL_OUT(print, v); }
 void serial_print_pair(const char* msg, uint8_t v)       { serial_print_pair(msg, (int)v); }
 void serial_print_pair(const char* msg, uint16_t v)      { serial_print_pair(msg, (int)v); }
 void serial_print_pair(const char* msg, uint32_t v)      { serial_print_pair(msg, (long)v); }
 void serial_print_pair(const char* msg, bool v)          { serial_print_pair(msg, (int)v); }
 void serial_print_pair(const char* msg, void *v)         { serial_print_pair(msg, (int)v); }
 
-void serial_spaces(uint8_t count) { count *= (PROPORTIONAL_FONT_RATIO); while (count--) MKSERIAL.write(' '); }
+#if HAS_SERIAL_TX_STATS
+
+  uint32_t serial_skipped = 0;
+
+  bool serial_skip_optional() {
+    if (!planner.blocks_queued() || MKSERIAL.availableForWrite() < (TX_BUFFER_SIZE) / 2) return false;
+    serial_skipped++;
+    return true;
+  }
+
+#endif
+
+void serial_spaces(uint8_t count) { count *= (PROPORTIONAL_FONT_RATIO); while (count--) HAL::serialWriteByte(' '); }
 
 #if ENABLED(DEBUG_LEVELING_FEATURE)
 
@@ -60,11 +60,33 @@ extern uint8_t mk_debug_flags;
 #define DISCONNECT      "//action:disconnect" // command for host that support action
 #define REQUEST_PAUSE   "RequestPause:"       // command for host that support action
 
-#define SERIAL_INIT(baud)                   do{ MKSERIAL.begin(baud); HAL::delayMilliseconds(1); }while(0)
+/**
+ * Call METHOD on the host port HAL::serial_port selects, or on all of them
+ */
+#if NUM_SERIAL > 1
+  #define SERIAL_OUT(METHOD, ...)           do{ if (HAL::serial_port != 1) MKSERIAL.METHOD(__VA_ARGS__); \
+                                                if (HAL::serial_port != 0) MKSERIAL2.METHOD(__VA_ARGS__); }while(0)
+#else
+  #define SERIAL_OUT(METHOD, ...)           MKSERIAL.METHOD(__VA_ARGS__)
+#endif
+
+#define SERIAL_INIT(baud)                   do{ HAL::serialSetBaudrate(baud); HAL::delayMilliseconds(1); }while(0)
 
 // Functions for serial printing from PROGMEM. (Saves loads of SRAM.)
 void serialprintPGM(const char* str);
 
+/**
+ * Output the host can do without (auto reports, busy, echo): true to
+ * skip or defer it, when the printer moves and the TX buffer is more
+ * than half full, rather than stall the main loop until it drains.
+ */
+#if HAS_SERIAL_TX_STATS
+  extern uint32_t serial_skipped;
+  bool serial_skip_optional();
+#else
+  FORCE_INLINE bool serial_skip_optional() { return false; }
+#endif
+
 #define SERIAL_PS(message)                  (serialprintPGM(message))
 #define SERIAL_PGM(message)                 (serialprintPGM(PSTR(message)))
 
@@ -72,8 +94,8 @@ void serialprintPGM(const char* str);
 #define SERIAL_MSG(msg)                     SERIAL_PGM(msg)
 #define SERIAL_TXT(txt)                     (serial_print(txt))
 #define SERIAL_VAL(val, ...)                (serial_print(val, ## __VA_ARGS__))
-#define SERIAL_CHR(c)                       ((void)MKSERIAL.write(c))
-#define SERIAL_EOL()                        ((void)MKSERIAL.write('\n'))
+#define SERIAL_CHR(c)                       SERIAL_OUT(write, c)
+#define SERIAL_EOL()                        SERIAL_OUT(write, '\n')
 
 #define SERIAL_SP(C)                        serial_spaces(C)
 
@@ -99,17 +121,17 @@ void serialprintPGM(const char* str);
 #define SERIAL_LMT(str, msg, txt)           do{ SERIAL_STR(str); SERIAL_MT(msg, txt); SERIAL_EOL(); }while(0)
 #define SERIAL_LMV(str, msg, val, ...)      do{ SERIAL_STR(str); SERIAL_MV(msg, val, ## __VA_ARGS__); SERIAL_EOL(); }while(0)
 
-FORCE_INLINE void serial_print(const char *v)   { MKSERIAL.print(v); }
-FORCE_INLINE void serial_print(char v)          { MKSERIAL.print(v); }
-FORCE_INLINE void serial_print(int v)           { MKSERIAL.print(v); }
-FORCE_INLINE void serial_print(long v)          { MKSERIAL.print(v); }
-FORCE_INLINE void serial_print(double v)        { MKSERIAL.print(v); }
-FORCE_INLINE void serial_print(float v, int n)  { MKSERIAL.print(v, n); }
-FORCE_INLINE void serial_print(uint8_t v)       { MKSERIAL.print((int)v); }
-FORCE_INLINE void serial_print(uint16_t v)      { MKSERIAL.print((int)v); }
-FORCE_INLINE void serial_print(uint32_t v)      { MKSERIAL.print((long)v); }
-FORCE_INLINE void serial_print(bool v)          { MKSERIAL.print((int)v); }
-FORCE_INLINE void serial_print(void *v)         { MKSERIAL.print((int)v); }
+FORCE_INLINE void serial_print(const char *v)   { SERIAL_OUT(print, v); }
+FORCE_INLINE void serial_print(char v)          { SERIAL_OUT(print, v); }
+FORCE_INLINE void serial_print(int v)           { SERIAL_OUT(print, v); }
+FORCE_INLINE void serial_print(long v)          { SERIAL_OUT(print, v); }
+FORCE_INLINE void serial_print(double v)        { SERIAL_OUT(print, v); }
+FORCE_INLINE void serial_print(float v, int n)  { SERIAL_OUT(print, v, n); }
+FORCE_INLINE void serial_print(uint8_t v)       { SERIAL_OUT(print, (int)v); }
+FORCE_INLINE void serial_print(uint16_t v)      { SERIAL_OUT(print, (int)v); }
+FORCE_INLINE void serial_print(uint32_t v)      { SERIAL_OUT(print, (long)v); }
+FORCE_INLINE void serial_print(bool v)          { SERIAL_OUT(print, (int)v); }
+FORCE_INLINE void serial_print(void *v)         { SERIAL_OUT(print, (int)v); }
 
 void serial_print_pair(const char* msg, const char *v);
 void serial_print_pair(const char* msg, char v);
@@ -102,6 +102,10 @@ HAL::~HAL() {
 
 bool HAL::execute_100ms = false;
 
+#if NUM_SERIAL > 1
+  int8_t HAL::serial_port = -1;
+#endif
+
 // do any hardware-specific initialization here
 void HAL::hwSetup(void) {
 
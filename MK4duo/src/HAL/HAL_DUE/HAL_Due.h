@@ -135,6 +135,26 @@ static const Pin  NoPin = -1;
   #endif
 #endif
 
+// The arduino core buffers and waits, no TX statistics
+#define HAS_SERIAL_TX_STATS false
+
+#if ENABLED(SERIAL_PORT_2)
+  #if SERIAL_PORT_2 == -1
+    #define MKSERIAL2 SerialUSB
+  #elif SERIAL_PORT_2 == 0
+    #define MKSERIAL2 Serial
+  #elif SERIAL_PORT_2 == 1
+    #define MKSERIAL2 Serial1
+  #elif SERIAL_PORT_2 == 2
+    #define MKSERIAL2 Serial2
+  #elif SERIAL_PORT_2 == 3
+    #define MKSERIAL2 Serial3
+  #endif
+  #define NUM_SERIAL 2
+#else
+  #define NUM_SERIAL 1
+#endif
+
 // EEPROM START
 #define EEPROM_OFFSET 10
 
@@ -235,6 +255,10 @@ class HAL {
 
     static bool execute_100ms;
 
+    #if NUM_SERIAL > 1
+      static int8_t serial_port;  // Port written by serialWriteByte, -1 = all
+    #endif
+
   public: /** Public Function */
 
     #if ANALOG_INPUTS > 0
@@ -286,18 +310,35 @@ class HAL {
     }
     static inline void serialSetBaudrate(long baud) {
       MKSERIAL.begin(baud);
+      #if NUM_SERIAL > 1
+        MKSERIAL2.begin(baud);
+      #endif
       HAL::delayMilliseconds(1);
     }
-    static inline bool serialByteAvailable() {
+    static inline bool serialByteAvailable(const uint8_t port=0) {
+      #if NUM_SERIAL > 1
+        if (port) return MKSERIAL2.available() > 0;
+      #endif
       return MKSERIAL.available() > 0;
     }
-    static inline uint8_t serialReadByte() {
+    static inline uint8_t serialReadByte(const uint8_t port=0) {
+      #if NUM_SERIAL > 1
+        if (port) return MKSERIAL2.read();
+      #endif
       return MKSERIAL.read();
     }
     static inline void serialWriteByte(char c) {
-      MKSERIAL.write(c);
+      #if NUM_SERIAL > 1
+        if (serial_port != 1) MKSERIAL.write(c);
+        if (serial_port != 0) MKSERIAL2.write(c);
+      #else
+        MKSERIAL.write(c);
+      #endif
     }
-    static inline void serialFlush() {
+    static inline void serialFlush(const uint8_t port=0) {
+      #if NUM_SERIAL > 1
+        if (port) { MKSERIAL2.flush(); return; }
+      #endif
       MKSERIAL.flush();
     }
 
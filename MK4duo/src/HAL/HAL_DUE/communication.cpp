@@ -58,55 +58,16 @@ void Com::PS_PGM(FSTRINGPARAM(ptr)) {
 }
 
 void Com::printNumber(uint32_t n) {
-  char buf[11]; // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[10];
-  *str = '\0';
-  do {
-    unsigned long m = n;
-    n /= 10;
-    *--str = '0' + (m - 10 * n);
-  } while(n);
-
-  print(str);
+  char buf[NUMBER_STR_SIZE];
+  ultostr(buf, n);
+  print(buf);
 }
 
+// Formatted in integer math, then written in one go
 void Com::printFloat(float number, uint8_t digits) {
-  if (isnan(number)) {
-    PS_PGM(TNAN);
-    return;
-  }
-  if (isinf(number)) {
-    PS_PGM(TINF);
-    return;
-  }
-  // Handle negative numbers
-  if (number < 0.0) {
-    print('-');
-    number = -number;
-  }
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  float rounding = 0.5;
-  for (uint8_t i = 0; i < digits; ++i)
-    rounding /= 10.0;
-
-  number += rounding;
-
-  // Extract the integer part of the number and print it
-  unsigned long int_part = (unsigned long)number;
-  float remainder = number - (float)int_part;
-  printNumber(int_part);
-
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0)
-    print('.');
-
-  // Extract digits from the remainder one at a time
-  while (digits-- > 0) {
-    remainder *= 10.0;
-    int toPrint = int(remainder);
-    print(toPrint);
-    remainder -= toPrint;
-  }
+  char buf[NUMBER_STR_SIZE];
+  ftostrn(buf, number, digits);
+  print(buf);
 }
 
 void Com::print(const char* text) {
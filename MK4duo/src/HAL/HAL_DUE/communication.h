@@ -51,6 +51,9 @@ extern uint8_t mk_debug_flags;
     print_xyz(PSTR("  " STRINGIFY(VAR) "="), PSTR(" : " SUFFIX "\n"), VAR); }while(0)
 #endif
 
+// The arduino core has no TX statistics, optional output is always sent
+FORCE_INLINE bool serial_skip_optional() { return false; }
+
 class Com {
 
   public:
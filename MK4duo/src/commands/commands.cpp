@@ -40,35 +40,102 @@ Commands commands;
  * sending commands to Marlin, and lines will be checked for sequentiality.
  * M110 N<int> sets the current line number.
  */
-long  Commands::gcode_N             = 0,
-      Commands::gcode_LastN         = 0,
-      Commands::Stopped_gcode_LastN = 0;
+long  Commands::gcode_N                     = 0,
+      Commands::gcode_LastN[NUM_SERIAL]     = { 0 },
+      Commands::Stopped_gcode_LastN         = 0;
 
-bool Commands::send_ok[BUFSIZE];
-
-char Commands::command_queue[BUFSIZE][MAX_CMD_SIZE];
+char Commands::command_queue[CMD_QUEUE_SIZE];
 
 // Inactivity shutdown
 millis_t Commands::previous_cmd_ms = 0;
 
+#if NUM_SERIAL > 1
+  bool Commands::out_of_queue = false;
+#endif
+
 /**
  * Private Parameters
  */
 
 /**
  * GCode Command Queue
- * A simple ring buffer of BUFSIZE command strings.
+ * A ring buffer of CMD_QUEUE_SIZE bytes holding commands of any length.
+ *
+ * Each command is stored as a CMD_ENTRY_HEAD header (size, port to
+ * send the ok to, decoded record position, with POWER_LOSS_JOURNAL the
+ * SD file position of its line) followed by its text and the room for its
+ * decoded record. A command never wraps: when the end of the buffer is
+ * too short a zero size marks the rest as unused.
  *
  * Commands are copied into this buffer by the command injectors
  * (immediate, serial, sd card) and they are processed sequentially by
  * the main loop. The process_next_command function parses the next
  * command and hands off execution to individual handler functions.
  */
-uint8_t Commands::commands_in_queue       = 0,
-        Commands::cmd_queue_index_r       = 0,  // Ring buffer read position
-        Commands::cmd_queue_index_w       = 0;  // Ring buffer write position
+uint8_t   Commands::commands_in_queue = 0;
+uint16_t  Commands::cmd_queue_index_r = 0,  // Ring buffer read position
+          Commands::cmd_queue_index_w = 0,  // Ring buffer write position
+          Commands::cmd_queue_used    = 0;  // Bytes taken by queued commands
 
-int Commands::serial_count = 0;
+bool Commands::running = false;
+
+#if HAS_POWER_LOSS_JOURNAL
+  uint32_t Commands::sd_entry_pos = JOURNAL_NO_SDPOS;
+#endif
+
+#if ENABLED(BINARY_GCODE_TRANSPORT)
+  bool    Commands::binary_mode   = false;
+  uint8_t Commands::binary_count  = 0;
+
+  #define BINARY_FRAME_SYNC     0xFE  // Never part of an ASCII line
+  #define BINARY_FRAME_TIMEOUT  200   // ms
+  #define BINARY_PAYLOAD_MAX    (MAX_CMD_SIZE - 1 - CMD_RECORD_HEAD + 13)  // Queued as a record with no text
+
+  static uint8_t  binary_frame[BINARY_PAYLOAD_MAX + 4];
+  static uint16_t binary_crc;
+  static millis_t previous_binary_ms = 0;
+#endif
+
+/**
+ * What the serial scanner learns of a line as its bytes arrive,
+ * so the line is never scanned again before it is queued.
+ */
+typedef struct {
+  uint8_t   checksum,   // XOR of the bytes before '*'
+            words;      // Words started on the line
+  bool      number,     // Line starts with N
+            star,       // '*' seen, its value is the checksum sent
+            m110,       // Command is M110, its N parameter is the new line number
+            neg;        // Value of the word is negative
+  char      letter,     // Letter of the word being read, 0 between words
+            cmd_letter; // G, M or T of the command, 0 before it
+  uint16_t  cmd_code;
+  int32_t   value,      // Value of the word being read
+            n,          // Line number
+            sum;        // Checksum sent
+} serial_line_t;
+
+/**
+ * Line being received on each host port
+ */
+typedef struct {
+  char          buffer[MAX_CMD_SIZE];
+  uint8_t       count;    // Bytes stored in the buffer
+  bool          comment,  // Skipping a comment up to the line end
+                ready,    // Line checked, waiting for room in the queue
+                query;    // The ready line is a status query
+  serial_line_t line;
+} serial_input_t;
+
+static serial_input_t serial_input[NUM_SERIAL];
+
+#if NUM_SERIAL > 1
+  static uint8_t serial_queued[NUM_SERIAL];   // Commands of each port in the queue
+#endif
+
+#if ENABLED(NO_TIMEOUTS) && NO_TIMEOUTS > 0
+  static millis_t last_command_time = 0;
+#endif
 
 /**
  * Next Injected Command pointer. NULL if no commands are being injected.
@@ -82,15 +149,75 @@ const char *Commands::injected_commands_P = NULL;
  */
 
 /**
- * Get all commands waiting on the serial port and queue them.
+ * Close the word being read and keep what the line checks need
+ */
+static void serial_word_end(serial_line_t &line) {
+  if (!line.letter) return;
+  const int32_t v = line.neg ? -line.value : line.value;
+  if (line.letter == '*')
+    line.sum = v;
+  else if (line.letter == 'N') {
+    if (line.words == 1) { line.number = true; line.n = v; }
+    else if (line.m110) line.n = v;   // M110 N<int> gives the line number
+  }
+  else if (!line.cmd_letter && (line.letter == 'G' || line.letter == 'M' || line.letter == 'T')) {
+    line.cmd_letter = line.letter;
+    line.cmd_code = v;
+    line.m110 = (line.letter == 'M' && v == 110);
+  }
+  line.letter = 0;
+}
+
+/**
+ * Scan one stored byte of a serial line: checksum, line number and command
+ */
+static void serial_scan(serial_line_t &line, const char c) {
+  if (c == '*') {
+    serial_word_end(line);
+    line.star = true;
+    line.letter = '*';
+    line.value = 0;
+    line.neg = false;
+    return;
+  }
+  if (!line.star) line.checksum ^= c;
+  if (NUMERIC(c)) {
+    // Digits past the range of int32 are dropped, N, '*' and the code fit well before
+    if (line.letter && line.value < 214748364L) line.value = line.value * 10 + (c - '0');
+  }
+  else if (WITHIN(c, 'A', 'Z')) {
+    serial_word_end(line);
+    line.letter = c;
+    line.value = 0;
+    line.neg = false;
+    line.words++;
+  }
+  else if (c == '-' && line.letter && !line.value) line.neg = true;
+  else if (c != ' ' || line.value) serial_word_end(line);
+}
+
+#if NUM_SERIAL > 1
+
+  /**
+   * Commands that only report, safe to run ahead of the queue
+   */
+  static bool is_status_query(const serial_line_t &line) {
+    if (line.cmd_letter != 'M') return false;
+    switch (line.cmd_code) {
+      case 27: case 31: case 105: case 114: case 115: case 119: return true;
+      default: return false;
+    }
+  }
+
+#endif
+
+/**
+ * Get all commands waiting on the serial ports and queue them.
  * Exit when the buffer is full or when no more characters are
- * left on the serial port.
+ * left on the serial ports.
  */
 void Commands::get_serial_commands() {
 
-  static char serial_line_buffer[MAX_CMD_SIZE];
-  static bool serial_comment_mode = false;
-
   #if HAS_DOOR
     if (READ(DOOR_PIN) != DOOR_PIN_INVERTING) {
       KEEPALIVE_STATE(DOOR_OPEN);
@@ -101,7 +228,6 @@ void Commands::get_serial_commands() {
   // If the command buffer is empty for too long,
   // send "wait" to indicate MK4duo is still waiting.
   #if ENABLED(NO_TIMEOUTS) && NO_TIMEOUTS > 0
-    static millis_t last_command_time = 0;
     millis_t ms = millis();
     if (commands_in_queue == 0 && !HAL::serialByteAvailable() && ELAPSED(ms, last_command_time + NO_TIMEOUTS)) {
       SERIAL_L(WT);
@@ -109,125 +235,354 @@ void Commands::get_serial_commands() {
     }
   #endif
 
+  #if NUM_SERIAL > 1
+    // One line from each port in turn, so no host can fill the queue alone.
+    // Errors and answers go to the port the line came from.
+    const int8_t port = HAL::serial_port;   // Of the command running, if called from idle
+    bool more;
+    do {
+      more = false;
+      for (uint8_t p = 0; p < NUM_SERIAL; p++) {
+        HAL::serial_port = p;
+        if (get_serial_line(p)) more = true;
+      }
+    } while (more);
+    HAL::serial_port = port;
+  #else
+    while (get_serial_line(0)) { /* nada */ }
+  #endif
+}
+
+/**
+ * Read a port up to the end of a line and queue it.
+ * Return true if a line was taken and the port may have more.
+ */
+bool Commands::get_serial_line(const uint8_t p) {
+
+  serial_input_t &in = serial_input[p];
+
+  #if ENABLED(SD_BINARY_UPLOAD)
+    // M577 takes every byte of the first port until the file is written,
+    // the other ports wait as their commands could reach the card
+    if (card.uploading) {
+      if (!p) {
+        while (card.uploading && HAL::serialByteAvailable()) card.uploadByte(HAL::serialReadByte());
+        if (card.uploading) card.uploadIdle();
+      }
+      return false;
+    }
+  #endif
+
+  // A checked line waits for room in the queue, the port waits with it
+  if (in.ready) {
+    #if NUM_SERIAL > 1
+      if (in.query) {
+        if (running) return false;
+        in.ready = false;
+        answer_query(in.buffer);
+        return true;
+      }
+    #endif
+    if (!enqueue_command(in.buffer, true)) return false;
+    in.ready = false;
+    return true;
+  }
+
+  #if ENABLED(BINARY_GCODE_TRANSPORT)
+    // A frame that stops arriving has lost bytes, ask for it again
+    if (!p && binary_count && !HAL::serialByteAvailable() && ELAPSED(millis(), previous_binary_ms + BINARY_FRAME_TIMEOUT)) {
+      gcode_line_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
+      return false;
+    }
+  #endif
+
   /**
-   * Loop while serial characters are incoming and the queue is not full
+   * Loop while serial characters are incoming. A whole line is read
+   * before it is queued and waits in the port buffer for room of its
+   * own length, a status query is answered without taking a slot.
    */
-  while (commands_in_queue < BUFSIZE && HAL::serialByteAvailable()) {
+  while (HAL::serialByteAvailable(p)) {
+
+    #if ENABLED(BINARY_GCODE_TRANSPORT)
+      // A frame is queued as it ends, it needs room for the longest command
+      if (!p && binary_mode && !open_command()) return false;
+    #endif
+
+    char serial_char = HAL::serialReadByte(p);
 
-    char serial_char = HAL::serialReadByte();
+    #if ENABLED(BINARY_GCODE_TRANSPORT)
+      // A sync byte at the start of a line begins a binary frame
+      if (!p && (binary_count || (binary_mode && !in.count && (uint8_t)serial_char == BINARY_FRAME_SYNC))) {
+        get_binary_byte(serial_char);
+        continue;
+      }
+    #endif
 
     /**
      * If the character ends the line
      */
     if (serial_char == '\n' || serial_char == '\r') {
 
-      serial_comment_mode = false; // end of line == end of comment
+      in.comment = false; // end of line == end of comment
 
-      if (!serial_count) continue; // skip empty lines
+      // Take the scanned state, the next line starts clean
+      serial_word_end(in.line);
+      const serial_line_t line = in.line;
+      memset(&in.line, 0, sizeof(in.line));
 
-      serial_line_buffer[serial_count] = 0; // terminate string
-      serial_count = 0; // reset buffer
+      if (!in.count) continue; // skip empty lines
 
-      char* command = serial_line_buffer;
+      while (in.count > 1 && in.buffer[in.count - 1] == ' ') in.count--; // trailing spaces
+      in.buffer[in.count] = 0; // terminate string
+      in.count = 0; // reset buffer
 
-      while (*command == ' ') command++; // skip any leading spaces
-      char  *npos = (*command == 'N') ? command : NULL, // Require the N parameter to start the line
-            *apos = strchr(command, '*');
+      if (line.number) {
 
-      if (npos) {
+        gcode_N = line.n;
 
-        bool M110 = strstr_P(command, PSTR("M110")) != NULL;
-
-        if (M110) {
-          char* n2pos = strchr(command + 4, 'N');
-          if (n2pos) npos = n2pos;
-        }
-
-        gcode_N = strtol(npos + 1, NULL, 10);
-
-        if (gcode_N != gcode_LastN + 1 && !M110) {
+        if (gcode_N != gcode_LastN[p] + 1 && !line.m110) {
           gcode_line_error(PSTR(MSG_ERR_LINE_NO));
-          return;
+          return false;
         }
 
-        if (apos) {
-          byte checksum = 0, count = 0;
-          while (command[count] != '*') checksum ^= command[count++];
-
-          if (strtol(apos + 1, NULL, 10) != checksum) {
-            gcode_line_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
-            return;
-          }
-          // if no errors, continue parsing
-        }
-        else {
+        if (!line.star) {
           gcode_line_error(PSTR(MSG_ERR_NO_CHECKSUM));
-          return;
+          return false;
         }
 
-        gcode_LastN = gcode_N;
+        if (line.sum != line.checksum) {
+          gcode_line_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
+          return false;
+        }
+
+        gcode_LastN[p] = gcode_N;
         // if no errors, continue parsing
       }
-      else if (apos) { // No '*' without 'N'
+      else if (line.star) { // No '*' without 'N'
         gcode_line_error(PSTR(MSG_ERR_NO_LINENUMBER_WITH_CHECKSUM), false);
-        return;
+        return false;
       }
 
       // Movement commands alert when stopped
-      if (printer.IsStopped()) {
-        char* gpos = strchr(command, 'G');
-        if (gpos) {
-          const int codenum = strtol(gpos + 1, NULL, 10);
-          switch (codenum) {
-            case 0:
-            case 1:
-            case 2:
-            case 3:
-              SERIAL_LM(ER, MSG_ERR_STOPPED);
-              LCD_MESSAGEPGM(MSG_STOPPED);
-              break;
-          }
-        }
+      if (printer.IsStopped() && line.cmd_letter == 'G' && line.cmd_code <= 3) {
+        SERIAL_LM(ER, MSG_ERR_STOPPED);
+        LCD_MESSAGEPGM(MSG_STOPPED);
       }
 
       #if DISABLED(EMERGENCY_PARSER)
         // If command was e-stop process now
-        if (strcmp(command, "M108") == 0) {
-          thermalManager.wait_for_heatup = false;
-          #if ENABLED(ULTIPANEL)
-            printer.wait_for_user = false;
-          #endif
+        if (line.cmd_letter == 'M') switch (line.cmd_code) {
+          case 108:
+            thermalManager.wait_for_heatup = false;
+            #if ENABLED(ULTIPANEL)
+              printer.wait_for_user = false;
+            #endif
+            break;
+          case 112: printer.kill(PSTR(MSG_KILLED)); break;
+          case 410: stepper.quickstop_stepper(); break;
         }
-        if (strcmp(command, "M112") == 0) printer.kill(PSTR(MSG_KILLED));
-        if (strcmp(command, "M410") == 0) { stepper.quickstop_stepper(); }
       #endif
 
       #if ENABLED(NO_TIMEOUTS) && NO_TIMEOUTS > 0
         last_command_time = ms;
       #endif
 
-      // Add the command to the queue
-      enqueue_command(serial_line_buffer, true);
+      #if NUM_SERIAL > 1
+        // Nothing of this port is queued, a status query can't overtake it
+        if (!serial_queued[p] && is_status_query(line)) {
+          if (running) {
+            in.ready = in.query = true;   // Answer from loop, the parser is in use
+            return false;
+          }
+          answer_query(in.buffer);
+          return true;
+        }
+        in.query = false;
+      #endif
+
+      // Add the command to the queue, or keep it until there is room
+      if (!enqueue_command(in.buffer, true)) {
+        in.ready = true;
+        return false;
+      }
+      return true;
+    }
+    else if (in.comment) {
+      // Comments are not stored or checked
     }
-    else if (serial_count >= MAX_CMD_SIZE - 1) {
+    else if (in.count >= MAX_CMD_SIZE - 1) {
       // Keep fetching, but ignore normal characters beyond the max length
       // The command will be injected when EOL is reached
     }
-    else if (serial_char == '\\') { // Handle escapes
-      if (HAL::serialByteAvailable()) {
-        // if we have one more character, copy it over
-        serial_char = HAL::serialReadByte();
-        if (!serial_comment_mode) serial_line_buffer[serial_count++] = serial_char;
+    else {
+      if (serial_char == '\\') { // Handle escapes
+        // if we have one more character, copy it over, otherwise do nothing
+        if (!HAL::serialByteAvailable(p)) continue;
+        serial_char = HAL::serialReadByte(p);
       }
-      // otherwise do nothing
-    }
-    else { // its not a newline, carriage return or escape char
-      if (serial_char == ';') serial_comment_mode = true;
-      if (!serial_comment_mode) serial_line_buffer[serial_count++] = serial_char;
+      else if (serial_char == ';') {
+        in.comment = true;
+        continue;
+      }
+      else if (serial_char == ' ' && !in.count)
+        continue; // skip any leading spaces
+
+      // Every stored byte is scanned once, the text stops at '*'
+      const bool star = in.line.star;
+      serial_scan(in.line, serial_char);
+      if (!star && !in.line.star) in.buffer[in.count++] = serial_char;
     }
-  } // queue has space, serial has data
+  } // serial has data
+
+  return false;
 }
 
+#if ENABLED(BINARY_GCODE_TRANSPORT)
+
+  /**
+   * Binary frame, little endian:
+   *
+   *   BINARY_FRAME_SYNC, length (uint8) of the payload, payload, crc (uint16)
+   *
+   *   Payload: sequence (uint16), letter (G M T), code (uint16),
+   *            params (uint32 mask, bit 0 = A ... bit 25 = Z),
+   *            ints (uint32 mask of params sent as int32 rather than float),
+   *            one 4 byte value per param in A-Z order, a float NAN for no value.
+   *
+   *   The crc is CRC-16/CCITT-FALSE over the length and payload bytes.
+   *   The sequence is the line number shared with N in ASCII lines.
+   */
+  void Commands::get_binary_byte(const uint8_t c) {
+    previous_binary_ms = millis();
+
+    // A payload holds at least the fixed fields and fits a queue slot
+    if (binary_count == 1 && !WITHIN(c, 13, BINARY_PAYLOAD_MAX)) {
+      gcode_line_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
+      return;
+    }
+
+    binary_frame[binary_count] = c;
+
+    // The crc is computed as bytes arrive
+    if (binary_count == 0)
+      binary_crc = 0xFFFF;
+    else if (binary_count <= binary_frame[1] + 1) {
+      binary_crc ^= (uint16_t)c << 8;
+      for (uint8_t b = 8; b--;)
+        binary_crc = (binary_crc & 0x8000) ? (binary_crc << 1) ^ 0x1021 : binary_crc << 1;
+    }
+
+    if (++binary_count == binary_frame[1] + 4) {
+      binary_count = 0;
+      commit_binary_frame(binary_frame);
+    }
+  }
+
+  void Commands::commit_binary_frame(const uint8_t * const frame) {
+    const uint8_t len = frame[1];
+
+    uint16_t crc;
+    uint32_t mask;
+    memcpy(&crc, frame + len + 2, sizeof(crc));
+    memcpy(&mask, frame + 7, sizeof(mask));
+
+    uint8_t count = 0;
+    for (uint32_t m = mask; m; m >>= 1) count += m & 1;
+
+    if (crc != binary_crc || (mask >> 26) || len != 13 + 4 * count) {
+      gcode_line_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
+      return;
+    }
+
+    const char letter = frame[4];
+    uint16_t seq, code;
+    memcpy(&seq, frame + 2, sizeof(seq));
+    memcpy(&code, frame + 5, sizeof(code));
+
+    if (letter == 'M' && code == 110) {
+      // M110 N sets the line number, as for ASCII
+      gcode_LastN[0] = seq;
+      const uint8_t n_ind = 'N' - 'A';
+      if ((mask >> n_ind) & 1) {
+        uint8_t offset = 15;
+        for (uint8_t ind = 0; ind < n_ind; ind++)
+          if ((mask >> ind) & 1) offset += 4;
+        uint32_t ints;
+        int32_t n;
+        memcpy(&ints, frame + 11, sizeof(ints));
+        memcpy(&n, frame + offset, sizeof(n));
+        if (!((ints >> n_ind) & 1)) {
+          float f;
+          memcpy(&f, &n, sizeof(f));
+          n = f;
+        }
+        gcode_LastN[0] = n;
+      }
+    }
+    else if (seq != (uint16_t)(gcode_LastN[0] + 1)) {
+      gcode_line_error(PSTR(MSG_ERR_LINE_NO));
+      return;
+    }
+    else
+      gcode_LastN[0]++;
+
+    // Movement commands alert when stopped
+    if (printer.IsStopped() && letter == 'G' && code <= 3) {
+      SERIAL_LM(ER, MSG_ERR_STOPPED);
+      LCD_MESSAGEPGM(MSG_STOPPED);
+    }
+
+    #if DISABLED(EMERGENCY_PARSER)
+      // If command was e-stop process now
+      if (letter == 'M') switch (code) {
+        case 108:
+          thermalManager.wait_for_heatup = false;
+          #if ENABLED(ULTIPANEL)
+            printer.wait_for_user = false;
+          #endif
+          break;
+        case 112: printer.kill(PSTR(MSG_KILLED)); break;
+        case 410: stepper.quickstop_stepper(); break;
+      }
+    #endif
+
+    #if HAS_SDSUPPORT
+      // M28 writes text to the file
+      if (card.saving) {
+        SERIAL_LM(ER, "Binary commands can't be written to SD");
+        SERIAL_L(OK);
+        return;
+      }
+    #endif
+
+    // Queue a record with no text, the frame has the same layout
+    char * const command = command_queue + cmd_queue_index_w + CMD_ENTRY_HEAD;
+    command[0] = '\0';
+    memcpy(command + 1, frame + 4, 11);                   // Letter, code and masks
+    command[12] = command[13] = command[14] = 0;          // Subcode, no text
+    memcpy(command + 1 + CMD_RECORD_HEAD, frame + 15, len - 13);
+    queue_entry(1 + CMD_RECORD_HEAD + len - 13, true, 1);
+  }
+
+#endif // BINARY_GCODE_TRANSPORT
+
+#if HAS_SDSUPPORT
+
+  /**
+   * The command word is M29, after the line number if any.
+   * M290 or an M29 in the text of another command is not.
+   */
+  static bool is_M29(const char* cmd) {
+    while (*cmd == ' ') ++cmd;
+    if (*cmd == 'N') {
+      do ++cmd; while (NUMERIC_SIGNED(*cmd));
+      while (*cmd == ' ') ++cmd;
+    }
+    return cmd[0] == 'M' && cmd[1] == '2' && cmd[2] == '9' && !NUMERIC(cmd[3]);
+  }
+
+#endif
+
 /**
  *  - Save or log commands to SD
  *  - Process available commands (if not saving)
@@ -235,19 +590,31 @@ void Commands::get_serial_commands() {
  */
 void Commands::loop() {
 
-  if (commands_in_queue < BUFSIZE) get_available_commands();
+  get_available_commands();
 
   #if HAS_SDSUPPORT
     card.checkautostart(false);
   #endif
 
-  if (commands_in_queue) {
+  if (commands_in_queue
+    #if ENABLED(SD_BINARY_UPLOAD)
+      && !card.uploading  // Queued commands wait for the M577 multi-block write to end
+    #endif
+  ) {
+
+    running = true;
+
+    #if NUM_SERIAL > 1
+      // Replies go to the port the command came from
+      const uint8_t port = command_queue[cmd_queue_index_r + 1];
+      HAL::serial_port = port - 1;
+    #endif
 
     #if HAS_SDSUPPORT
 
       if (card.saving) {
-        char* command = command_queue[cmd_queue_index_r];
-        if (strstr_P(command, PSTR("M29"))) {
+        char* command = current_command();
+        if (is_M29(command)) {
           // M29 closes the file
           card.finishWrite();
 
@@ -267,8 +634,19 @@ void Commands::loop() {
           ok_to_send();
         }
       }
-      else
+      else {
+        #if HAS_SD_WRITE_BUFFER
+          // M928 logs the commands run, not M29 that ends it
+          if (card.logging && !is_M29(current_command())) card.logLine(current_command());
+        #endif
+        #if HAS_POWER_LOSS_JOURNAL
+          journal.command(command_queue + cmd_queue_index_r + CMD_ENTRY_SDPOS);
+        #endif
         process_next_command();
+        #if HAS_POWER_LOSS_JOURNAL
+          journal.command(NULL);
+        #endif
+      }
 
     #else
 
@@ -279,8 +657,18 @@ void Commands::loop() {
     // The queue may be reset by a command handler or by code invoked by idle() within a handler
     if (commands_in_queue) {
       --commands_in_queue;
-      if (++cmd_queue_index_r >= BUFSIZE) cmd_queue_index_r = 0;
+      cmd_queue_used -= CMD_ENTRY_HEAD + (uint8_t)command_queue[cmd_queue_index_r];
+      cmd_queue_index_r = next_command(cmd_queue_index_r);
+      #if NUM_SERIAL > 1
+        if (port) serial_queued[port - 1]--;
+      #endif
     }
+
+    #if NUM_SERIAL > 1
+      HAL::serial_port = -1;
+    #endif
+
+    running = false;
   }
 
   endstops.report_state();
@@ -298,6 +686,9 @@ void Commands::loop() {
   void Commands::get_sdcard_commands() {
     static bool stop_buffering = false,
                 sd_comment_mode = false;
+    #if HAS_POWER_LOSS_JOURNAL || HAS_SD_GCODE_INFO
+      static uint32_t line_pos;   // Where the line being read starts
+    #endif
 
     if (!card.sdprinting) return;
 
@@ -325,52 +716,82 @@ void Commands::loop() {
     if (commands_in_queue == 0) stop_buffering = false;
 
     uint16_t sd_count = 0;
-    while (commands_in_queue < BUFSIZE && !card.eof() && !stop_buffering) {
-      const int16_t n = card.get();
-      char sd_char = (char)n;
-      if (card.eof() || n == -1
-          || sd_char == '\n' || sd_char == '\r'
-          || ((sd_char == '#' || sd_char == ':') && !sd_comment_mode)
-      ) {
-        if (card.eof()) {
-          SERIAL_EM(MSG_FILE_PRINTED);
-          card.printingHasFinished();
-          #if ENABLED(PRINTER_EVENT_LEDS)
-            LCD_MESSAGEPGM(MSG_INFO_COMPLETED_PRINTS);
-            set_led_color(0, 255, 0); // Green
-            #if HAS_RESUME_CONTINUE
-              enqueue_and_echo_commands_P(PSTR("M0")); // end of the queue!
-            #else
-              printer.safe_delay(1000);
-            #endif
-            set_led_color(0, 0, 0);   // OFF
-          #endif
-          card.checkautostart(true);
+    while (open_command() && !card.eof() && !stop_buffering) {
+      char * const command = command_queue + cmd_queue_index_w + CMD_ENTRY_HEAD;
+      const uint8_t *src;
+      const int16_t n = card.peekBlock(src);
+      char sd_char = 0;
+
+      if (n > 0) {
+        // Scan the block up to the end of the line, or to a comment
+        int16_t i = 0;
+        if (sd_comment_mode) {
+          const uint8_t * const lf = (const uint8_t*)memchr(src, '\n', n),
+                        * const cr = (const uint8_t*)memchr(src, '\r', lf ? lf - src : n);
+          i = cr ? cr - src : lf ? lf - src : n;
         }
-        else if (n == -1) {
-          SERIAL_LM(ER, MSG_SD_ERR_READ);
+        else {
+          #if HAS_POWER_LOSS_JOURNAL || HAS_SD_GCODE_INFO
+            if (!sd_count) line_pos = card.readPosition();
+          #endif
+          for (; i < n; i++) {
+            sd_char = src[i];
+            if (sd_char == '\n' || sd_char == '\r' || sd_char == '#' || sd_char == ':' || sd_char == ';') break;
+          }
+          // Characters beyond the max length are dropped, the command is injected at EOL
+          const uint16_t len = min((uint16_t)i, (uint16_t)(MAX_CMD_SIZE - 1 - sd_count));
+          memcpy(command + sd_count, src, len);
+          sd_count += len;
         }
-        if (sd_char == '#') stop_buffering = true;
-
-        sd_comment_mode = false; // for new command
 
-        if (!sd_count) continue; // skip empty lines (and comment lines)
+        if (i == n) {   // The line goes on in the next block
+          card.skipBlock(n);
+          continue;
+        }
 
-        command_queue[cmd_queue_index_w][sd_count] = '\0'; // terminate string
-        sd_count = 0; // clear sd line buffer
+        sd_char = src[i];
+        card.skipBlock(i + 1);
 
-        commit_command(false);
-      }
-      else if (sd_count >= MAX_CMD_SIZE - 1) {
-        /**
-         * Keep fetching, but ignore normal characters beyond the max length
-         * The command will be injected when EOL is reached
-         */
+        if (sd_char == ';') {
+          sd_comment_mode = true;
+          continue;
+        }
       }
-      else {
-        if (sd_char == ';') sd_comment_mode = true;
-        if (!sd_comment_mode) command_queue[cmd_queue_index_w][sd_count++] = sd_char;
+      else if (card.eof()) {
+        SERIAL_EM(MSG_FILE_PRINTED);
+        card.printingHasFinished();
+        #if ENABLED(PRINTER_EVENT_LEDS)
+          LCD_MESSAGEPGM(MSG_INFO_COMPLETED_PRINTS);
+          set_led_color(0, 255, 0); // Green
+          #if HAS_RESUME_CONTINUE
+            enqueue_and_echo_commands_P(PSTR("M0")); // end of the queue!
+          #else
+            printer.safe_delay(1000);
+          #endif
+          set_led_color(0, 0, 0);   // OFF
+        #endif
+        card.checkautostart(true);
       }
+      else
+        SERIAL_LM(ER, MSG_SD_ERR_READ);
+
+      // End of the line
+      if (sd_char == '#') stop_buffering = true;
+
+      sd_comment_mode = false; // for new command
+
+      if (!sd_count) continue; // skip empty lines (and comment lines)
+
+      command[sd_count] = '\0'; // terminate string
+      sd_count = 0; // clear sd line buffer
+
+      #if HAS_SD_GCODE_INFO
+        gcodeinfo.follow(command, line_pos, card.readPosition());
+      #endif
+      #if HAS_POWER_LOSS_JOURNAL
+        sd_entry_pos = line_pos;
+      #endif
+      commit_command(false);
     }
   }
 
@@ -382,8 +803,8 @@ void Commands::loop() {
  */
 void Commands::flush_and_request_resend() {
   //char command_queue[cmd_queue_index_r][100]="Resend:";
-  HAL::serialFlush();
-  SERIAL_LV(RESEND, gcode_LastN + 1);
+  HAL::serialFlush(command_port());
+  SERIAL_LV(RESEND, gcode_LastN[command_port()] + 1);
   ok_to_send();
 }
 
@@ -394,14 +815,22 @@ void Commands::flush_and_request_resend() {
  * If ADVANCED_OK is enabled also include:
  *   N<int>  Line number of the command, if any
  *   P<int>  Planner space remaining
- *   B<int>  Block queue space remaining
+ *   B<int>  Commands that still fit the queue, at the average size of those queued
+ *   L<int>  Line number of the last line taken from the host, lines after it
+ *           are still in the serial buffer and need B to fit
  */
 void Commands::ok_to_send() {
   refresh_cmd_timeout();
-  if (!send_ok[cmd_queue_index_r]) return;
+  if (commands_in_queue && !command_queue[cmd_queue_index_r + 1]) return;
+  send_ok(commands_in_queue ? current_command() : "");
+}
+
+/**
+ * Send the "ok" of a command, with its line number for ADVANCED_OK
+ */
+void Commands::send_ok(const char *p) {
   SERIAL_STR(OK);
   #if ENABLED(ADVANCED_OK)
-    char* p = command_queue[cmd_queue_index_r];
     if (*p == 'N') {
       SERIAL_CHR(' ');
       SERIAL_CHR(*p++);
@@ -409,7 +838,8 @@ void Commands::ok_to_send() {
         SERIAL_CHR(*p++);
     }
     SERIAL_MV(" P", (int)(BLOCK_BUFFER_SIZE - planner.movesplanned() - 1));
-    SERIAL_MV(" B", BUFSIZE - commands_in_queue);
+    SERIAL_MV(" B", (int)queue_room());
+    SERIAL_MV(" L", gcode_LastN[command_port()]);
   #endif
   SERIAL_EOL();
 }
@@ -465,17 +895,159 @@ void Commands::enqueue_and_echo_commands_P(const char * const pgcode) {
  * Clear the MK4duo command queue
  */
 void Commands::clear_command_queue() {
-  cmd_queue_index_r = cmd_queue_index_w;
+  cmd_queue_index_r = cmd_queue_index_w = cmd_queue_used = 0;
   commands_in_queue = 0;
+  #if NUM_SERIAL > 1
+    ZERO(serial_queued);
+  #endif
+}
+
+#if ENABLED(FASTER_GCODE_PARSER)
+
+  /**
+   * Decode the commands waiting in the queue, from the head when no
+   * command is being executed, else behind it. Called from idle, so the
+   * time spent waiting on a full planner takes the parsing off the
+   * dispatch path.
+   */
+  void Commands::decode_pending() {
+    #if HAS_SDSUPPORT
+      if (card.saving) return;  // M28 writes the text as it came
+    #endif
+    uint8_t n = 0;
+    uint16_t index = cmd_queue_index_r;
+    if (running) { n++; index = next_command(index); }
+    for (; n < commands_in_queue; n++, index = next_command(index)) {
+      if (!command_queue[index + 2]) {
+        decode_command(index);
+        return;                 // One per call, idle has other work
+      }
+    }
+  }
+
+  void Commands::decode_command(const uint16_t index) {
+    char * const entry = command_queue + index;
+    const uint8_t pos = parser.decode(entry + CMD_ENTRY_HEAD, (uint8_t)entry[0]);
+    entry[2] = pos ? pos : CMD_RECORD_TEXT;
+  }
+
+#endif // FASTER_GCODE_PARSER
+
+#if HAS_POWER_LOSS_JOURNAL
+
+  /**
+   * With the queue empty the SD reader stops at the start of a line
+   */
+  uint32_t Commands::queued_sdpos() {
+    if (!commands_in_queue) return card.sdprinting ? card.readPosition() : JOURNAL_NO_SDPOS;
+    uint32_t pos;
+    memcpy(&pos, command_queue + cmd_queue_index_r + CMD_ENTRY_SDPOS, sizeof(pos));
+    return pos;
+  }
+
+#endif
+
+/**
+ * Make sure a command of size bytes can be written at the write
+ * position, moving it to the start of the ring if the end is too
+ * short. Return false if the queue is too full.
+ */
+bool Commands::open_command(const uint8_t size/*=MAX_CMD_SIZE*/) {
+  if (!commands_in_queue) {
+    cmd_queue_index_r = cmd_queue_index_w = cmd_queue_used = 0;
+    return true;
+  }
+  if (commands_in_queue == 255 || cmd_queue_index_w == cmd_queue_index_r) return false;
+
+  const uint16_t need = CMD_ENTRY_HEAD + size;
+  if (cmd_queue_index_w < cmd_queue_index_r) return cmd_queue_index_r - cmd_queue_index_w >= need;
+  if (CMD_QUEUE_SIZE - cmd_queue_index_w >= need) return true;
+  if (cmd_queue_index_r < need) return false;
+
+  // Skip the end of the ring, the reader follows the zero size
+  if (cmd_queue_index_w < CMD_QUEUE_SIZE) command_queue[cmd_queue_index_w] = 0;
+  cmd_queue_index_w = 0;
+  return true;
+}
+
+#if ENABLED(ADVANCED_OK)
+
+/**
+ * Commands of the average queued size the queue still takes, placed as
+ * open_command() places them: the end of the ring too short for one
+ * is lost, the writer goes on from the start.
+ */
+uint8_t Commands::queue_room() {
+  if (!commands_in_queue) return CMD_QUEUE_SIZE / (CMD_ENTRY_HEAD + MAX_CMD_SIZE);
+  if (cmd_queue_index_w == cmd_queue_index_r) return 0;
+
+  const uint16_t size = cmd_queue_used / commands_in_queue;
+  uint16_t room = cmd_queue_index_w < cmd_queue_index_r
+    ? (cmd_queue_index_r - cmd_queue_index_w) / size
+    : (CMD_QUEUE_SIZE - cmd_queue_index_w) / size + cmd_queue_index_r / size;
+  // A line read ahead is in L but still waits for room, it takes one of them
+  for (uint8_t p = 0; p < NUM_SERIAL; p++)
+    if (serial_input[p].ready && !serial_input[p].query && room) room--;
+  NOMORE(room, 255 - commands_in_queue);
+  return room;
+}
+
+#endif // ADVANCED_OK
+
+/**
+ * Position of the command after the one at index
+ */
+uint16_t Commands::next_command(uint16_t index) {
+  index += CMD_ENTRY_HEAD + (uint8_t)command_queue[index];
+  if (index == cmd_queue_index_w) return index;
+  // Past the end or on the zero size the writer left before going back to the start
+  return (index >= CMD_QUEUE_SIZE || !command_queue[index]) ? 0 : index;
+}
+
+/**
+ * Close the command written at the write position, size bytes of text and record
+ */
+void Commands::queue_entry(const uint8_t size, const bool say_ok, const uint8_t record) {
+  char * const entry = command_queue + cmd_queue_index_w;
+  entry[0] = size;
+  entry[1] = say_ok ? 1 + command_port() : 0;   // Port to send the ok to, plus one
+  entry[2] = record;
+  #if HAS_POWER_LOSS_JOURNAL
+    memcpy(entry + CMD_ENTRY_SDPOS, &sd_entry_pos, sizeof(sd_entry_pos));
+    sd_entry_pos = JOURNAL_NO_SDPOS;
+  #endif
+  #if NUM_SERIAL > 1
+    if (say_ok) serial_queued[command_port()]++;
+  #endif
+  cmd_queue_index_w += CMD_ENTRY_HEAD + size;
+  cmd_queue_used += CMD_ENTRY_HEAD + size;
+  commands_in_queue++;
+}
+
+/**
+ * Bytes a command takes after its header: the text and, with
+ * FASTER_GCODE_PARSER, the room for the record decode() puts after it
+ */
+static uint8_t entry_size(const char * const command, uint8_t &record) {
+  uint8_t size = strlen(command) + 1;
+  record = 0;
+  #if ENABLED(FASTER_GCODE_PARSER)
+    const uint8_t params = parser.record_params(command);
+    if (size + CMD_RECORD_HEAD + 4 * params <= MAX_CMD_SIZE)
+      size += CMD_RECORD_HEAD + 4 * params;
+    else
+      record = CMD_RECORD_TEXT;
+  #endif
+  return size;
 }
 
 /**
  * Once a new command is in the ring buffer, call this to commit it
  */
 void Commands::commit_command(bool say_ok) {
-  send_ok[cmd_queue_index_w] = say_ok;
-  if (++cmd_queue_index_w >= BUFSIZE) cmd_queue_index_w = 0;
-  commands_in_queue++;
+  uint8_t record;
+  const uint8_t size = entry_size(command_queue + cmd_queue_index_w + CMD_ENTRY_HEAD, record);
+  queue_entry(size, say_ok, record);
 }
 
 /**
@@ -484,9 +1056,12 @@ void Commands::commit_command(bool say_ok) {
  * Return false for a full buffer, or if the 'command' is a comment.
  */
 bool Commands::enqueue_command(const char* cmd, bool say_ok/*=false*/) {
-  if (*cmd == ';' || commands_in_queue >= BUFSIZE) return false;
-  strcpy(command_queue[cmd_queue_index_w], cmd);
-  commit_command(say_ok);
+  if (*cmd == ';') return false;
+  uint8_t record;
+  const uint8_t size = entry_size(cmd, record);
+  if (!open_command(size)) return false;
+  strcpy(command_queue + cmd_queue_index_w + CMD_ENTRY_HEAD, cmd);
+  queue_entry(size, say_ok, record);
   return true;
 }
 
@@ -510,14 +1085,24 @@ bool Commands::enqueue_and_echo_command(const char* cmd, bool say_ok/*=false*/)
 void Commands::gcode_line_error(const char* err, const bool doFlush/*=true*/) {
   SERIAL_STR(ER);
   SERIAL_PS(err);
-  SERIAL_EV(gcode_LastN);
+  SERIAL_EV(gcode_LastN[command_port()]);
   //Serial.println(gcode_N);
   if (doFlush) flush_and_request_resend();
-  serial_count = 0;
+  serial_input[command_port()].count = 0;
+  #if ENABLED(BINARY_GCODE_TRANSPORT)
+    binary_count = 0;
+  #endif
 }
 
 void Commands::unknown_command_error() {
-  SERIAL_SMV(ECHO, MSG_UNKNOWN_COMMAND, parser.command_ptr);
+  #if ENABLED(BINARY_GCODE_TRANSPORT)
+    if (!*parser.command_ptr) {   // Binary frame
+      SERIAL_SMV(ECHO, MSG_UNKNOWN_COMMAND, parser.command_letter);
+      SERIAL_VAL(parser.codenum);
+    }
+    else
+  #endif
+      SERIAL_SMV(ECHO, MSG_UNKNOWN_COMMAND, parser.command_ptr);
   SERIAL_CHR('"');
   SERIAL_EOL();
 }
@@ -539,61 +1124,53 @@ void Commands::unknown_command_error() {
  */
 void Commands::process_next_command() {
 
-  char * const current_command = command_queue[cmd_queue_index_r];
-
-  if (DEBUGGING(ECHO)) SERIAL_LV(ECHO, current_command);
+  char * const current_command = this->current_command();
 
   KEEPALIVE_STATE(IN_HANDLER);
 
-  // Parse the next command in the queue
-  parser.parse(current_command);
+  if (DEBUGGING(ECHO) && *current_command && !serial_skip_optional()) SERIAL_LV(ECHO, current_command);
+
+  // Parse the next command in the queue, unless it was decoded while waiting
+  #if ENABLED(FASTER_GCODE_PARSER)
+    const uint8_t record = command_queue[cmd_queue_index_r + 2];
+    if (record && record != CMD_RECORD_TEXT)
+      parser.parse_record(current_command, record);
+    else
+  #endif
+      parser.parse(current_command);
+
+  execute_command();
+
+  KEEPALIVE_STATE(NOT_BUSY);
+
+  ok_to_send();
+}
+
+/**
+ * Dispatch the parsed command to its handler
+ */
+void Commands::execute_command() {
 
   // Handle a known G, M, or T
   switch (parser.command_letter) {
 
     case 'G': {
       const uint16_t code_num = parser.codenum;
-      G_CODE_TYPE start   = 0,
-                  middle  = 0,
-                  end     = COUNT(GCode_Table) - 1;
-
       if (code_num <= 1) { // Execute directly the most common Gcodes
         EXECUTE_G0_G1(code_num);
       }
-      else if (WITHIN(code_num, GCode_Table[start].code, GCode_Table[end].code)) {
-        while (start <= end) {
-          middle = (start + end) >> 1;
-          if (GCode_Table[middle].code == code_num) {
-            GCode_Table[middle].command(); // Command found, execute it
-            break;
-          }
-          else if (GCode_Table[middle].code < code_num)
-            start = middle + 1;
-          else
-            end = middle - 1;
-        }
+      else if (code_num < COUNT(GCode_Index::index)) {
+        const uint8_t index = pgm_read_byte(&GCode_Index::index[code_num]);
+        if (index) GCode_Table[index - 1].command(); // Command found, execute it
       }
     }
     break;
 
     case 'M': {
       const uint16_t code_num = parser.codenum;
-      M_CODE_TYPE start   = 0,
-                  middle  = 0,
-                  end     = COUNT(MCode_Table) - 1;
-
-      if (WITHIN(code_num, MCode_Table[start].code, MCode_Table[end].code)) {
-        while (start <= end) {
-          middle = (start + end) >> 1;
-          if (MCode_Table[middle].code == code_num) {
-            MCode_Table[middle].command(); // Command found, execute it
-            break;
-          }
-          else if (MCode_Table[middle].code < code_num)
-            start = middle + 1;
-          else
-            end = middle - 1;
-        }
+      if (code_num < COUNT(MCode_Index::index)) {
+        const uint8_t index = pgm_read_byte(&MCode_Index::index[code_num]);
+        if (index) MCode_Table[index - 1].command(); // Command found, execute it
       }
     }
     break;
@@ -604,8 +1181,20 @@ void Commands::process_next_command() {
 
     default: unknown_command_error();
   }
+}
 
-  KEEPALIVE_STATE(NOT_BUSY);
+#if NUM_SERIAL > 1
 
-  ok_to_send();
-}
+  /**
+   * Run a status query from a port with nothing queued, out of the queue
+   */
+  void Commands::answer_query(char * const command) {
+    if (DEBUGGING(ECHO)) SERIAL_LV(ECHO, command);
+    parser.parse(command);
+    running = out_of_queue = true;
+    execute_command();
+    running = out_of_queue = false;
+    send_ok(command);
+  }
+
+#endif
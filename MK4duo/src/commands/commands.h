@@ -39,23 +39,49 @@ class Commands {
 
   public: /** Public Parameters */
 
-    static char command_queue[BUFSIZE][MAX_CMD_SIZE];
+    #define CMD_QUEUE_SIZE  (BUFSIZE * (MAX_CMD_SIZE) + CMD_ENTRY_HEAD) // The longest command with its header fits even with BUFSIZE 1
+    #if HAS_POWER_LOSS_JOURNAL
+      #define CMD_ENTRY_HEAD  7 // Size, send ok, decoded record position and SD file position of each command
+      #define CMD_ENTRY_SDPOS 3 // Offset of the SD file position in the header
+    #else
+      #define CMD_ENTRY_HEAD  3 // Size, send ok and decoded record position of each command
+    #endif
+    static char command_queue[CMD_QUEUE_SIZE];
 
     static long gcode_N,
-                gcode_LastN,
+                gcode_LastN[NUM_SERIAL],  // Line number of each host port
                 Stopped_gcode_LastN;
 
     static millis_t previous_cmd_ms;
 
+    #if NUM_SERIAL > 1
+      static bool out_of_queue;   // A status query runs ahead of the queue, don't wait for moves
+    #endif
+
+    #if ENABLED(BINARY_GCODE_TRANSPORT)
+      static bool binary_mode;    // Accept binary frames, set with M575
+    #endif
+
   private: /** Private Parameters */
 
-    static bool send_ok[BUFSIZE];
+    static uint8_t  commands_in_queue;
+    static uint16_t cmd_queue_index_r,  // Ring buffer read position
+                    cmd_queue_index_w,  // Ring buffer write position
+                    cmd_queue_used;     // Bytes taken by queued commands
 
-    static uint8_t  commands_in_queue,
-                    cmd_queue_index_r,  // Ring buffer read position
-                    cmd_queue_index_w;  // Ring buffer write position
+    static bool running;                // A command is being run, the parser is in use
+
+    #if HAS_POWER_LOSS_JOURNAL
+      static uint32_t sd_entry_pos;     // SD file position of the line queue_entry() closes
+    #endif
+
+    #if ENABLED(BINARY_GCODE_TRANSPORT)
+      static uint8_t binary_count;  // Bytes of a binary frame received so far
+    #endif
 
-    static int serial_count;
+    #if ENABLED(FASTER_GCODE_PARSER)
+      #define CMD_RECORD_TEXT 0xFF  // Too long to decode, parse the text
+    #endif
 
     static const char *injected_commands_P;
 
@@ -71,18 +97,55 @@ class Commands {
     static bool enqueue_and_echo_command(const char* cmd, bool say_ok=false);
     static void enqueue_and_echo_commands_P(const char * const pgcode);
 
-    FORCE_INLINE static void save_last_gcode()      { Stopped_gcode_LastN = gcode_LastN; }
-    FORCE_INLINE static void reset_send_ok()        { for (uint8_t i = 0; i < COUNT(send_ok); i++) send_ok[i] = true; }
+    FORCE_INLINE static void save_last_gcode()      { Stopped_gcode_LastN = gcode_LastN[command_port()]; }
     FORCE_INLINE static void refresh_cmd_timeout()  { previous_cmd_ms = millis(); }
 
+    // Host port of the command being run or the line being read, 0 for other sources
+    FORCE_INLINE static uint8_t command_port() {
+      #if NUM_SERIAL > 1
+        return HAL::serial_port > 0 ? HAL::serial_port : 0;
+      #else
+        return 0;
+      #endif
+    }
+
+    #if ENABLED(FASTER_GCODE_PARSER)
+      static void decode_pending();
+    #endif
+
+    #if HAS_POWER_LOSS_JOURNAL
+      // SD file position of the next command to run, JOURNAL_NO_SDPOS if it doesn't come from SD
+      static uint32_t queued_sdpos();
+    #endif
+
   private: /** Private Function */
 
     static void get_serial_commands();
+    static bool get_serial_line(const uint8_t p);
+    #if ENABLED(BINARY_GCODE_TRANSPORT)
+      static void get_binary_byte(const uint8_t c);
+      static void commit_binary_frame(const uint8_t * const frame);
+    #endif
     #if HAS_SDSUPPORT
       static void get_sdcard_commands();
     #endif
 
     static void process_next_command();
+    static void execute_command();
+    static void send_ok(const char *p);
+    #if NUM_SERIAL > 1
+      static void answer_query(char * const command);
+    #endif
+    #if ENABLED(FASTER_GCODE_PARSER)
+      static void decode_command(const uint16_t index);
+    #endif
+    static bool open_command(const uint8_t size=MAX_CMD_SIZE);
+    #if ENABLED(ADVANCED_OK)
+      static uint8_t queue_room();
+    #endif
+    static uint16_t next_command(uint16_t index);
+    FORCE_INLINE static char* current_command() { return command_queue + cmd_queue_index_r + CMD_ENTRY_HEAD; }
+    static void queue_entry(const uint8_t size, const bool say_ok, const uint8_t record);
     static void commit_command(bool say_ok);
     static void unknown_command_error();
     static void gcode_line_error(const char* err, const bool doFlush=true);
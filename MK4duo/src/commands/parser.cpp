@@ -52,6 +52,9 @@ uint16_t GCodeParser::codenum;
   // Optimized Parameters
   byte GCodeParser::codebits[4];   // found bits
   uint8_t GCodeParser::param[26];  // parameter offsets from command_ptr
+  bool GCodeParser::binary,
+       GCodeParser::value_is_int;
+  uint32_t GCodeParser::binary_ints;
 #else
   char *GCodeParser::command_args; // start of parameters
 #endif
@@ -59,6 +62,77 @@ uint16_t GCodeParser::codenum;
 // Create a global instance of the GCodeParser singleton
 GCodeParser parser;
 
+/**
+ * Integer and fraction are kept apart, up to 9 fraction digits. When the
+ * value fits 24 bits as a whole number one float division rounds it,
+ * otherwise the mantissa is made bit by bit and rounded to nearest even.
+ */
+float GCodeParser::parse_float(const char *p, char **end/*=NULL*/) {
+  const char * const start = p;
+  while (*p == ' ') ++p;
+  const bool neg = (*p == '-');
+  if (neg || *p == '+') ++p;
+
+  uint32_t ip = 0, f = 0, d = 1;
+  uint8_t scale = 0;
+  bool digits = false, point = false, sticky = false;
+  for (;; ++p) {
+    const char c = *p;
+    if (c == '.' && !point) { point = true; continue; }
+    if (!NUMERIC(c)) break;
+    digits = true;
+    if (point) {
+      if (d < 1000000000UL) { f = f * 10 + (c - '0'); d *= 10; }
+      else sticky |= (c != '0');  // Beyond 9 digits only says "a bit more"
+    }
+    else if (ip <= 429496728UL) ip = ip * 10 + (c - '0');
+    else scale++;                 // Integer part over 32 bits
+  }
+  if (end) *end = (char*)(digits ? p : start);
+
+  // Zero has no bit to normalise to, the loop below would never end
+  if (!ip && !f) return neg ? -0.0f : 0.0f;
+
+  float v;
+  if (ip < (1UL << 24) / d)
+    v = (float)(ip * d + f) / (float)d;   // Both exact, the division rounds once
+  else {
+    // 25 bits of ip + f / d, the last one to round with
+    uint32_t q = ip, r = f;
+    int8_t e = 0;
+    while (q >= (1UL << 25)) { sticky |= (q & 1); q >>= 1; e++; }
+    while (q < (1UL << 24)) {
+      r <<= 1; q <<= 1; e--;
+      if (r >= d) { r -= d; q |= 1; }
+    }
+    sticky |= (r != 0);
+    const bool half = (q & 1);
+    q >>= 1; e++;
+    if (half && (sticky || (q & 1))) q++;
+    v = ldexp(q, e);
+  }
+  while (scale--) v *= 10;
+  return neg ? -v : v;
+}
+
+int32_t GCodeParser::parse_long(const char *p, char **end/*=NULL*/) {
+  const char * const start = p;
+  while (*p == ' ') ++p;
+  const bool neg = (*p == '-');
+  if (neg || *p == '+') ++p;
+  const char * const digits = p;
+  uint32_t v = 0;
+  while (NUMERIC(*p)) v = v * 10 + (*p++ - '0');
+  if (end) *end = (char*)(p != digits ? p : start);
+  return neg ? -(int32_t)v : (int32_t)v;
+}
+
+// M codes taking the rest of the line as a string, they have no parameters
+static bool string_code(const char letter, const uint16_t code) {
+  if (letter == 'M') switch (code) { case 23: case 28: case 30: case 36: case 117: case 118: case 577: case 928: return true; default: break; }
+  return false;
+}
+
 // Populate all fields by parsing a single line of GCode
 // 58 bytes of SRAM are used to speed up seen/value
 void GCodeParser::parse(char *p) {
@@ -129,7 +203,7 @@ void GCodeParser::parse(char *p) {
   #endif
 
   // Only use string_arg for these M codes
-  if (letter == 'M') switch (codenum) { case 23: case 28: case 30: case 117: case 118: case 928: string_arg = p; return; default: break; }
+  if (string_code(letter, codenum)) { string_arg = p; return; }
 
   #if ENABLED(DEBUG_GCODE_PARSER)
     const bool debug = (codenum == 800);
@@ -207,6 +281,145 @@ void GCodeParser::parse(char *p) {
   }
 }
 
+#if ENABLED(FASTER_GCODE_PARSER)
+
+  uint8_t GCodeParser::decode(char * const p, const uint8_t size) {
+
+    // Keep the state of the command being executed
+    char * const  old_command_ptr = command_ptr,
+         * const  old_string_arg = string_arg,
+         * const  old_value_ptr = value_ptr;
+    const char    old_letter = command_letter;
+    const uint16_t old_codenum = codenum;
+    #if USE_GCODE_SUBCODES
+      const uint8_t old_subcode = subcode;
+    #endif
+    const bool    old_binary = binary,
+                  old_is_int = value_is_int;
+    const uint32_t old_ints = binary_ints;
+    byte old_codebits[COUNT(codebits)];
+    uint8_t old_param[COUNT(param)];
+    COPY_ARRAY(old_codebits, codebits);
+    COPY_ARRAY(old_param, param);
+
+    parse(p);
+
+    uint32_t mask;
+    memcpy(&mask, codebits, sizeof(mask));
+
+    uint8_t count = 0;
+    for (uint32_t m = mask; m; m >>= 1) count += m & 1;
+
+    const uint8_t pos = strlen(p) + 1;
+    char * const r = p + pos;
+
+    if (pos + CMD_RECORD_HEAD + 4 * count <= size) {
+
+      uint32_t ints = 0;
+      uint8_t offset = CMD_RECORD_HEAD;
+      for (uint8_t ind = 0; ind < COUNT(param); ind++) {
+        if (!((mask >> ind) & 1)) continue;
+        char * const v = param[ind] ? command_ptr + param[ind] : (char*)NULL;
+        char *end = v;
+        const int32_t l = v ? parse_long(v, &end) : 0;
+        if (v && end != v && *end != '.') {
+          ints |= 1UL << ind;
+          memcpy(r + offset, &l, sizeof(l));
+        }
+        else {
+          value_ptr = v;
+          const float f = v ? value_float() : NAN;
+          memcpy(r + offset, &f, sizeof(f));
+        }
+        offset += 4;
+      }
+
+      r[0] = command_letter;
+      memcpy(r + 1, &codenum, sizeof(codenum));
+      memcpy(r + 3, &mask, sizeof(mask));
+      memcpy(r + 7, &ints, sizeof(ints));
+      #if USE_GCODE_SUBCODES
+        r[11] = subcode;
+      #else
+        r[11] = 0;
+      #endif
+      r[12] = command_ptr - p;
+      r[13] = string_arg ? string_arg - p : 0;
+    }
+
+    command_ptr = old_command_ptr;
+    string_arg = old_string_arg;
+    value_ptr = old_value_ptr;
+    command_letter = old_letter;
+    codenum = old_codenum;
+    #if USE_GCODE_SUBCODES
+      subcode = old_subcode;
+    #endif
+    binary = old_binary;
+    value_is_int = old_is_int;
+    binary_ints = old_ints;
+    COPY_ARRAY(codebits, old_codebits);
+    COPY_ARRAY(param, old_param);
+
+    return pos + CMD_RECORD_HEAD + 4 * count <= size ? pos : 0;
+  }
+
+  uint8_t GCodeParser::record_params(const char *p) {
+    while (*p == ' ') ++p;
+    if (*p == 'N' && NUMERIC_SIGNED(p[1])) {
+      p += 2;
+      while (NUMERIC(*p)) ++p;
+      while (*p == ' ') ++p;
+    }
+    const char letter = *p;
+    if (letter) ++p;
+    while (*p == ' ') ++p;
+    uint16_t code = 0;
+    while (NUMERIC(*p)) code = code * 10 + (*p++ - '0');
+    if (string_code(letter, code)) return 0;
+
+    // Every A-Z after the command word is a parameter, a repeated one is stored once
+    uint32_t mask = 0;
+    for (; *p; ++p) if (WITHIN(*p, 'A', 'Z')) mask |= 1UL << (*p - 'A');
+    uint8_t count = 0;
+    for (; mask; mask >>= 1) count += mask & 1;
+    return count;
+  }
+
+  void GCodeParser::parse_record(char * const p, const uint8_t pos) {
+
+    reset();
+    binary = true;
+
+    const char * const r = p + pos;
+
+    command_ptr = p + r[12];
+    if (r[13]) string_arg = p + r[13];
+
+    uint32_t mask;
+    memcpy(&codenum, r + 1, sizeof(codenum));
+    memcpy(&mask, r + 3, sizeof(mask));
+    memcpy(&binary_ints, r + 7, sizeof(binary_ints));
+    #if USE_GCODE_SUBCODES
+      subcode = r[11];
+    #endif
+
+    switch (r[0]) { case 'G': case 'M': case 'T': command_letter = r[0]; break; default: return; }
+
+    uint8_t offset = pos + CMD_RECORD_HEAD;
+    for (uint8_t ind = 0; mask; ind++, mask >>= 1) {
+      if (!(mask & 1)) continue;
+      float f;
+      memcpy(&f, p + offset, sizeof(f));
+      const bool has_num = ((binary_ints >> ind) & 1) || !isnan(f);
+      SBI(codebits[PARAM_IND(ind)], PARAM_BIT(ind));
+      param[ind] = has_num ? p + offset - command_ptr : 0;
+      offset += 4;
+    }
+  }
+
+#endif // FASTER_GCODE_PARSER
+
 #if ENABLED(DEBUG_GCODE_PARSER)
 
   void GCodeParser::debug() {
@@ -38,6 +38,16 @@
 #define LETTER_IND(N) PARAM_IND(LETTER_OFF(N))
 #define LETTER_BIT(N) PARAM_BIT(LETTER_OFF(N))
 
+#if ENABLED(FASTER_GCODE_PARSER)
+  /**
+   * Decoded command record, stored in the queue slot after the text:
+   *   letter, code (uint16), params (uint32 A-Z mask), ints (uint32 mask
+   *   of int32 values), subcode, command and string_arg offsets in the
+   *   slot, then a 4 byte value per parameter. A float NAN is no value.
+   */
+  #define CMD_RECORD_HEAD 14
+#endif
+
 typedef enum {
   TEMPUNIT_C,
   TEMPUNIT_K,
@@ -81,10 +91,19 @@ class GCodeParser {
       static uint8_t subcode;     // .1
     #endif
 
+    #if ENABLED(FASTER_GCODE_PARSER)
+      static bool binary;         // Parameters are decoded 4 byte values, not text
+    #endif
+
   private: /** Private Parameters */
 
     static char *value_ptr;       // Set by seen, used to fetch the value
 
+    #if ENABLED(FASTER_GCODE_PARSER)
+      static uint32_t binary_ints;  // Parameters decoded as int32 rather than float
+      static bool value_is_int;     // Set by seen, type of the binary value
+    #endif
+
     #if ENABLED(FASTER_GCODE_PARSER)
       static byte codebits[4];    // Parameters pre-scanned
       static uint8_t param[26];   // For A-Z, offsets into command args
@@ -126,7 +145,10 @@ class GCodeParser {
         const uint8_t ind = LETTER_OFF(c);
         if (ind >= COUNT(param)) return false; // Only A-Z
         const bool b = TEST(codebits[PARAM_IND(ind)], PARAM_BIT(ind));
-        if (b) value_ptr = param[ind] ? command_ptr + param[ind] : (char*)NULL;
+        if (b) {
+          value_ptr = param[ind] ? command_ptr + param[ind] : (char*)NULL;
+          value_is_int = (binary_ints >> ind) & 1;
+        }
         return b;
       }
 
@@ -160,35 +182,66 @@ class GCodeParser {
     // This uses 54 bytes of SRAM to speed up seen/value
     static void parse(char * p);
 
+    #if ENABLED(FASTER_GCODE_PARSER)
+      /**
+       * Parse a command once, as it waits in the queue, and store the result
+       * after its text. Return the record position, 0 if it doesn't fit.
+       * The state of the command being executed is left untouched.
+       */
+      static uint8_t decode(char * const p, const uint8_t size);
+
+      // Values decode() will store for a command, at most: each A-Z after the command word once
+      static uint8_t record_params(const char *p);
+
+      // Populate all fields from a decoded record, no text is scanned
+      static void parse_record(char * const p, const uint8_t pos);
+    #endif
+
+    /**
+     * Numbers as G-code writes them, [+-]digits[.digits] with no exponent.
+     * The float is correctly rounded for up to 9 fraction digits.
+     * Like strtod and strtol, end is set past the number or to p if none.
+     */
+    static float parse_float(const char *p, char **end=NULL);
+    static int32_t parse_long(const char *p, char **end=NULL);
+
     // Code value pointer was set
     FORCE_INLINE static bool has_value() { return value_ptr != NULL; }
 
     // Seen a parameter with a value
     FORCE_INLINE static bool seenval(const char c) { return seen(c) && has_value(); }
 
-    // Float removes 'E' to prevent scientific notation interpretation
+    #if ENABLED(FASTER_GCODE_PARSER)
+      // Binary values may be unaligned
+      FORCE_INLINE static int32_t binary_raw() { int32_t v; memcpy(&v, value_ptr, sizeof(v)); return v; }
+      FORCE_INLINE static float binary_float() {
+        if (value_is_int) return binary_raw();
+        float f;
+        memcpy(&f, value_ptr, sizeof(f));
+        return f;
+      }
+      FORCE_INLINE static int32_t binary_long() { return value_is_int ? binary_raw() : (int32_t)binary_float(); }
+    #endif
+
+    // Float stops at 'E', there is no scientific notation
     inline static float value_float() {
       if (value_ptr) {
-        char *e = value_ptr;
-        for (;;) {
-          const char c = *e;
-          if (c == '\0' || c == ' ') break;
-          if (c == 'E' || c == 'e') {
-            *e = '\0';
-            const float ret = strtod(value_ptr, NULL);
-            *e = c;
-            return ret;
-          }
-          ++e;
-        }
-        return strtod(value_ptr, NULL);
+        #if ENABLED(FASTER_GCODE_PARSER)
+          if (binary) return binary_float();
+        #endif
+        return parse_float(value_ptr);
       }
       return 0.0;
     }
 
     // Code value as a long or ulong
-    FORCE_INLINE static int32_t   value_long()  { return value_ptr ? strtol(value_ptr, NULL, 10) : 0L; }
-    FORCE_INLINE static uint32_t  value_ulong() { return value_ptr ? strtoul(value_ptr, NULL, 10) : 0UL; }
+    #if ENABLED(FASTER_GCODE_PARSER)
+      FORCE_INLINE static int32_t   value_long()  { return value_ptr ? (binary ? binary_long() : parse_long(value_ptr)) : 0L; }
+      FORCE_INLINE static uint32_t  value_ulong() { return value_ptr ? (binary ? (uint32_t)binary_long() : (uint32_t)parse_long(value_ptr)) : 0UL; }
+    #else
+      FORCE_INLINE static int32_t   value_long()  { return value_ptr ? parse_long(value_ptr) : 0L; }
+      FORCE_INLINE static uint32_t  value_ulong() { return value_ptr ? (uint32_t)parse_long(value_ptr) : 0UL; }
+    #endif
 
     // Code value for use as time
     FORCE_INLINE static millis_t  value_millis()              { return value_ulong(); }
@@ -317,6 +370,8 @@ class GCodeParser {
         subcode = 0;                      // No command sub-code
       #endif
       #if ENABLED(FASTER_GCODE_PARSER)
+        binary = false;                   // Text parameters
+        binary_ints = 0;
         ZERO(codebits);                   // No codes yet
         //ZERO(param);                    // No parameters (should be safe to comment out this line)
       #endif
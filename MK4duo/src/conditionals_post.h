@@ -464,6 +464,12 @@
 // SD support
 #define HAS_SDSUPPORT       (ENABLED(SDSUPPORT))
 #define HAS_EEPROM_SD       (ENABLED(EEPROM_SD) && ENABLED(SDSUPPORT))
+#define HAS_SD_READ_AHEAD   (ENABLED(SD_READ_AHEAD) && ENABLED(SDSUPPORT))
+#define HAS_SD_WRITE_BUFFER (ENABLED(SD_WRITE_BUFFER) && ENABLED(SDSUPPORT))
+#define HAS_SD_DIR_INDEX    (ENABLED(SD_DIR_INDEX) && ENABLED(SDSUPPORT))
+#define HAS_SD_GCODE_INFO   (ENABLED(SD_GCODE_INFO) && ENABLED(SDSUPPORT))
+#define HAS_SD_PRINT_TIME   (ENABLED(SD_PRINT_TIME) && HAS_SD_GCODE_INFO)
+#define HAS_POWER_LOSS_JOURNAL (ENABLED(POWER_LOSS_JOURNAL) && ENABLED(SDSUPPORT))
 
 // Extruder Encoder
 #define HAS_EXT_ENCODER     (ENABLED(EXTRUDER_ENCODER_CONTROL) && (HAS_E0_ENC || HAS_E1_ENC || HAS_E2_ENC || HAS_E3_ENC || HAS_E4_ENC || HAS_E5_ENC))
@@ -577,6 +583,7 @@
 #define HAS_MESH              (ENABLED(AUTO_BED_LEVELING_BILINEAR) || ENABLED(AUTO_BED_LEVELING_UBL) || ENABLED(MESH_BED_LEVELING))
 #define PLANNER_LEVELING      (ABL_PLANAR || ABL_GRID || ENABLED(MESH_BED_LEVELING) || UBL_DELTA)
 #define HAS_PROBING_PROCEDURE (HAS_ABL || ENABLED(Z_MIN_PROBE_REPEATABILITY_TEST))
+#define HAS_MESH_STORAGE      (ENABLED(AUTO_BED_LEVELING_UBL) || (ENABLED(AUTO_BED_LEVELING_BILINEAR) && ENABLED(EEPROM_SETTINGS) && !HAS_EEPROM_SD))
 
 #if HAS_PROBING_PROCEDURE
   #define PROBE_BED_WIDTH     abs(RIGHT_PROBE_BED_POSITION - (LEFT_PROBE_BED_POSITION))
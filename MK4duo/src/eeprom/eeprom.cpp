@@ -38,7 +38,7 @@
 
 #include "../../base.h"
 
-#define EEPROM_VERSION "MKV37"
+#define EEPROM_VERSION "MKV38"
 
 /**
  * MKV437 EEPROM Layout:
@@ -80,7 +80,7 @@
  *                        GRID_MAX_POINTS_Y                     (uint8_t)
  *                        bedlevel.bilinear_grid_spacing        (int x2)   from G29: (B-F)/X, (R-L)/Y
  *  G29   L F             bedlevel.bilinear_start               (int x2)
- *                        bedlevel.z_values[][]                 (float x9, up to float x256)
+ *                        bedlevel.z_values[][]                 (float mean + int16 um x9, up to x256)
  *
  * AUTO_BED_LEVELING_UBL:
  *  G29 A                 ubl.state.active                      (bool)
@@ -166,6 +166,10 @@
  *  M900  K               planner.extruder_advance_k            (float)
  *  M900  WHD             planner.advance_ed_ratio              (float)
  *
+ * Stored from the end of the EEPROM (UBL or BILINEAR):
+ *  meshes_end            mesh bank table                       (int16_t x MESH_BANK_SLOTS, bool, crc)
+ *  G29 S / M323 S        mesh slots, growing down              (mesh_geometry_t, float mean, int16 um x GRID_MAX_POINTS, crc)
+ *
  */
 
 EEPROM eeprom;
@@ -208,6 +212,8 @@ void EEPROM::Postprocess() {
 
   #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
     bedlevel.refresh_bed_level();
+  #elif ABL_PLANAR
+    bedlevel.refresh_correction();
   #endif
 
   #if ENABLED(HYSTERESIS)
@@ -226,10 +232,16 @@ void EEPROM::Postprocess() {
 
   bool EEPROM::eeprom_error = false;
 
-  #if ENABLED(AUTO_BED_LEVELING_UBL)
+  #if HAS_MESH_STORAGE
     int EEPROM::meshes_begin = 0;
   #endif
 
+  #if ENABLED(AUTO_BED_LEVELING_UBL)
+    #define MESH_Z_VALUES ubl.z_values
+  #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
+    #define MESH_Z_VALUES bedlevel.z_values
+  #endif
+
   void EEPROM::crc16(uint16_t *crc, const void * const data, uint16_t cnt) {
     uint8_t *ptr = (uint8_t *)data;
     while (cnt--) {
@@ -384,7 +396,7 @@ void EEPROM::Postprocess() {
       EEPROM_WRITE(grid_max_y);             // 1 byte
       EEPROM_WRITE(bedlevel.bilinear_grid_spacing);  // 2 ints
       EEPROM_WRITE(bedlevel.bilinear_start);         // 2 ints
-      EEPROM_WRITE(bedlevel.z_values);               // 9-256 floats
+      write_mesh(eeprom_index, bedlevel.z_values, &working_crc);  // packed, 4 + 2 bytes per point
     #endif // AUTO_BED_LEVELING_BILINEAR
 
     #if ENABLED(AUTO_BED_LEVELING_UBL)
@@ -566,6 +578,10 @@ void EEPROM::Postprocess() {
     if (!eeprom_error) {
       const int eeprom_size = eeprom_index;
 
+      #if HAS_MESH_STORAGE
+        meshes_begin = (eeprom_size + 32) & 0xFFF8; // Same padding as Load_Settings
+      #endif
+
       const uint16_t final_crc = working_crc;
 
       // Write the EEPROM header
@@ -699,14 +715,18 @@ void EEPROM::Postprocess() {
           bedlevel.set_bed_leveling_enabled(false);
           EEPROM_READ(bedlevel.bilinear_grid_spacing); // 2 ints
           EEPROM_READ(bedlevel.bilinear_start);        // 2 ints
-          EEPROM_READ(bedlevel.z_values);              // 9 to 256 floats
+          read_mesh(eeprom_index, bedlevel.z_values, &working_crc);  // packed, 4 + 2 bytes per point
         }
         else { // EEPROM data is stale
           // Skip past disabled (or stale) Bilinear Grid data
           int bgs[2], bs[2];
           EEPROM_READ(bgs);
           EEPROM_READ(bs);
-          for (uint16_t q = grid_max_x * grid_max_y; q--;) EEPROM_READ(dummy);
+          EEPROM_READ(dummy);
+          for (uint16_t q = grid_max_x * grid_max_y; q--;) {
+            int16_t packed;
+            EEPROM_READ(packed);
+          }
         }
       #endif // AUTO_BED_LEVELING_BILINEAR
 
@@ -892,11 +912,14 @@ void EEPROM::Postprocess() {
 
       #endif
 
-      #if ENABLED(AUTO_BED_LEVELING_UBL)
-
+      #if HAS_MESH_STORAGE
         meshes_begin = (eeprom_index + 32) & 0xFFF8;  // Pad the end of configuration data so it
                                                       // can float up or down a little bit without
                                                       // disrupting the mesh data
+      #endif
+
+      #if ENABLED(AUTO_BED_LEVELING_UBL)
+
         ubl.report_state();
 
         if (!ubl.sanity_check()) {
@@ -915,8 +938,7 @@ void EEPROM::Postprocess() {
           ubl.reset();
         }
 
-        if (ubl.state.storage_slot >= 0) {
-          load_mesh(ubl.state.storage_slot);
+        if (ubl.state.storage_slot >= 0 && load_mesh(ubl.state.storage_slot)) {
           #if ENABLED(EEPROM_CHITCHAT)
             SERIAL_MV("Mesh ", ubl.state.storage_slot);
             SERIAL_EM(" loaded from storage.");
@@ -929,6 +951,17 @@ void EEPROM::Postprocess() {
           #endif
         }
       #endif
+
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        if (!load_mesh_bank()) bedlevel.mesh_bank_reset();
+        bedlevel.mesh_bank_mark(
+          #if ENABLED(AUTO_BED_LEVELING_UBL)
+            ubl.state.storage_slot
+          #else
+            -1
+          #endif
+        );
+      #endif
     }
 
     #if ENABLED(EEPROM_CHITCHAT)
@@ -938,7 +971,55 @@ void EEPROM::Postprocess() {
     return !eeprom_error;
   }
 
-  #if ENABLED(AUTO_BED_LEVELING_UBL)
+  #if ENABLED(AUTO_BED_LEVELING_UBL) || ENABLED(AUTO_BED_LEVELING_BILINEAR)
+
+    #define MESH_PACK_NAN -32768
+
+    /**
+     * Packed mesh: the mean Z as a float, then every point as an int16
+     * offset from the mean in micrometres. MESH_PACK_NAN marks a point
+     * that has not been probed.
+     */
+    void EEPROM::write_mesh(int &pos, const float z[][GRID_MAX_POINTS_Y], uint16_t *crc) {
+      float mean = 0.0;
+      uint16_t count = 0;
+      for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+        for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
+          if (!isnan(z[x][y])) { mean += z[x][y]; count++; }
+      if (count) mean /= count;
+
+      write_data(pos, (uint8_t*)&mean, sizeof(mean), crc);
+
+      for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++) {
+        for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++) {
+          const int16_t v = isnan(z[x][y]) ? MESH_PACK_NAN : constrain(lroundf((z[x][y] - mean) * 1000.0), -32767L, 32767L);
+          write_data(pos, (uint8_t*)&v, sizeof(v), crc);
+        }
+      }
+    }
+
+    // With mix under 1 each point read is blended into z, 0 keeps z
+    void EEPROM::read_mesh(int &pos, float z[][GRID_MAX_POINTS_Y], uint16_t *crc, const float mix/*=1.0*/) {
+      float mean;
+      read_data(pos, (uint8_t*)&mean, sizeof(mean), crc);
+
+      for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++) {
+        for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++) {
+          int16_t v;
+          read_data(pos, (uint8_t*)&v, sizeof(v), crc);
+          const float read = v == MESH_PACK_NAN ? NAN : mean + v * 0.001;
+          z[x][y] = mix < 1.0 ? z[x][y] + (read - z[x][y]) * mix : read;
+        }
+      }
+    }
+
+  #endif // AUTO_BED_LEVELING_UBL || AUTO_BED_LEVELING_BILINEAR
+
+  #if HAS_MESH_STORAGE
+
+    // Geometry header, packed mesh and crc
+    #define MESH_SLOT_SIZE (sizeof(mesh_geometry_t) + sizeof(float) + (GRID_MAX_POINTS) * sizeof(int16_t) + sizeof(uint16_t))
+    #define MESH_SLOT_POS(S) (meshes_end - ((S) + 1) * (MESH_SLOT_SIZE))
 
     #if ENABLED(EEPROM_CHITCHAT)
       void ubl_invalid_slot(const int s) {
@@ -950,76 +1031,183 @@ void EEPROM::Postprocess() {
 
     int EEPROM::calc_num_meshes() {
       if (meshes_begin <= 0) return 0;
-      return (meshes_end - meshes_begin) / sizeof(ubl.z_values);
+      return (meshes_end - meshes_begin) / (MESH_SLOT_SIZE);
     }
 
-    void EEPROM::store_mesh(int8_t slot) {
-
+    void EEPROM::mesh_geometry(mesh_geometry_t &geometry) {
+      geometry.nx = GRID_MAX_POINTS_X;
+      geometry.ny = GRID_MAX_POINTS_Y;
       #if ENABLED(AUTO_BED_LEVELING_UBL)
-        const int a = calc_num_meshes();
-        if (!WITHIN(slot, 0, a - 1)) {
-          #if ENABLED(EEPROM_CHITCHAT)
-            ubl_invalid_slot(a);
-            SERIAL_MV("E2END=", E2END);
-            SERIAL_MV(" meshes_end=", meshes_end);
-            SERIAL_EMV(" slot=", slot);
-          #endif
-          return;
-        }
-
-        uint16_t crc = 0;
-        int pos = meshes_end - (slot + 1) * sizeof(ubl.z_values);
-
-        write_data(pos, (uint8_t *)&ubl.z_values, sizeof(ubl.z_values), &crc);
+        geometry.x0 = lroundf((UBL_MESH_MIN_X) * 10.0);
+        geometry.y0 = lroundf((UBL_MESH_MIN_Y) * 10.0);
+        geometry.dx = lroundf((MESH_X_DIST) * 10.0);
+        geometry.dy = lroundf((MESH_Y_DIST) * 10.0);
+      #else
+        geometry.x0 = bedlevel.bilinear_start[X_AXIS] * 10;
+        geometry.y0 = bedlevel.bilinear_start[Y_AXIS] * 10;
+        geometry.dx = bedlevel.bilinear_grid_spacing[X_AXIS] * 10;
+        geometry.dy = bedlevel.bilinear_grid_spacing[Y_AXIS] * 10;
+      #endif
+    }
 
-        // Write crc to MAT along with other data, or just tack on to the beginning or end
+    bool EEPROM::store_mesh(const int8_t slot) {
 
+      const int a = calc_num_meshes();
+      if (!WITHIN(slot, 0, a - 1)) {
         #if ENABLED(EEPROM_CHITCHAT)
-          SERIAL_EMV("Mesh saved in slot ", slot);
+          ubl_invalid_slot(a);
+          SERIAL_MV("E2END=", E2END);
+          SERIAL_MV(" meshes_end=", meshes_end);
+          SERIAL_EMV(" slot=", slot);
         #endif
+        return false;
+      }
 
-      #else
+      mesh_geometry_t geometry;
+      mesh_geometry(geometry);
+
+      uint16_t crc = 0;
+      int pos = MESH_SLOT_POS(slot);
 
-        // Other mesh types
+      write_data(pos, (uint8_t*)&geometry, sizeof(geometry), &crc);
+      write_mesh(pos, MESH_Z_VALUES, &crc);
+      const uint16_t slot_crc = crc;
+      write_data(pos, (uint8_t*)&slot_crc, sizeof(slot_crc), &crc);
 
+      #if ENABLED(EEPROM_CHITCHAT)
+        SERIAL_EMV("Mesh saved in slot ", slot);
       #endif
+
+      return !eeprom_error;
     }
 
-    void EEPROM::load_mesh(int8_t slot, void *into /* = 0 */) {
+    /**
+     * Read a slot through to check its crc and grid size
+     */
+    bool EEPROM::check_mesh(const int8_t slot, mesh_geometry_t &geometry, float &mean) {
+      if (!WITHIN(slot, 0, calc_num_meshes() - 1)) return false;
 
-      #if ENABLED(AUTO_BED_LEVELING_UBL)
+      uint16_t crc = 0, stored_crc;
+      int pos = MESH_SLOT_POS(slot);
 
-        const int16_t a = calc_num_meshes();
+      read_data(pos, (uint8_t*)&geometry, sizeof(geometry), &crc);
+      read_data(pos, (uint8_t*)&mean, sizeof(mean), &crc);
+      for (uint16_t i = GRID_MAX_POINTS; i--;) {
+        int16_t v;
+        read_data(pos, (uint8_t*)&v, sizeof(v), &crc);
+      }
+      const uint16_t slot_crc = crc;
+      read_data(pos, (uint8_t*)&stored_crc, sizeof(stored_crc), &crc);
 
-        if (!WITHIN(slot, 0, a - 1)) {
-          #if ENABLED(EEPROM_CHITCHAT)
-            ubl_invalid_slot(a);
-          #endif
-          return;
-        }
+      return slot_crc == stored_crc && geometry.nx == GRID_MAX_POINTS_X && geometry.ny == GRID_MAX_POINTS_Y;
+    }
 
-        uint16_t crc = 0;
-        int pos = meshes_end - (slot + 1) * sizeof(ubl.z_values);
-        uint8_t * const dest = into ? (uint8_t*)into : (uint8_t*)&ubl.z_values;
-        read_data(pos, dest, sizeof(ubl.z_values), &crc);
+    /**
+     * Load a slot into the active mesh or into a float[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y].
+     * UBL slots must match the configured mesh. A bilinear slot loaded into the active
+     * mesh brings its own origin and spacing, otherwise it must match the active grid.
+     */
+    bool EEPROM::load_mesh(const int8_t slot, void *into/*=0*/) {
 
-        // Compare crc with crc from MAT, or read from end
+      mesh_geometry_t geometry, active;
+      float mean;
 
+      if (!check_mesh(slot, geometry, mean)) {
         #if ENABLED(EEPROM_CHITCHAT)
-          SERIAL_EMV("Mesh loaded from slot ", slot);
+          SERIAL_EMV("?No valid mesh in slot ", slot);
         #endif
+        return false;
+      }
 
+      #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
+        const bool adopt = !into;
       #else
+        constexpr bool adopt = false;
+      #endif
+
+      mesh_geometry(active);
+      if (!adopt && memcmp(&geometry, &active, sizeof(geometry))) {
+        #if ENABLED(EEPROM_CHITCHAT)
+          SERIAL_EMV("?Mesh grid differs in slot ", slot);
+        #endif
+        return false;
+      }
 
-        // Other mesh types
+      uint16_t crc = 0;
+      int pos = MESH_SLOT_POS(slot) + sizeof(geometry);
+      read_mesh(pos, into ? (float(*)[GRID_MAX_POINTS_Y])into : MESH_Z_VALUES, &crc);
 
+      #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
+        if (adopt) {
+          bedlevel.bilinear_start[X_AXIS] = geometry.x0 / 10;
+          bedlevel.bilinear_start[Y_AXIS] = geometry.y0 / 10;
+          bedlevel.bilinear_grid_spacing[X_AXIS] = geometry.dx / 10;
+          bedlevel.bilinear_grid_spacing[Y_AXIS] = geometry.dy / 10;
+        }
       #endif
+
+      #if ENABLED(EEPROM_CHITCHAT)
+        SERIAL_EMV("Mesh loaded from slot ", slot);
+      #endif
+
+      return true;
     }
 
-    //void MarlinSettings::delete_mesh() { return; }
-    //void MarlinSettings::defrag_meshes() { return; }
+    bool EEPROM::clear_mesh(const int8_t slot) {
+      if (!WITHIN(slot, 0, calc_num_meshes() - 1)) return false;
+      uint16_t crc = 0;
+      int pos = MESH_SLOT_POS(slot);
+      const uint8_t empty = 0;
+      write_data(pos, &empty, sizeof(empty), &crc);   // A zero grid size never passes check_mesh
+      return !eeprom_error;
+    }
+
+    #if ENABLED(MESH_TEMPERATURE_BANK)
+
+      void EEPROM::store_mesh_bank() {
+        static_assert(sizeof(bedlevel.mesh_bank_temp) + sizeof(bedlevel.mesh_bank_auto) + 2 <= E2END - meshes_end, "Mesh bank table doesn't fit the MAT space.");
+        uint16_t crc = 0;
+        int pos = meshes_end;
+        write_data(pos, (uint8_t*)&bedlevel.mesh_bank_temp, sizeof(bedlevel.mesh_bank_temp), &crc);
+        write_data(pos, (uint8_t*)&bedlevel.mesh_bank_auto, sizeof(bedlevel.mesh_bank_auto), &crc);
+        const uint16_t table_crc = crc;
+        write_data(pos, (uint8_t*)&table_crc, sizeof(table_crc), &crc);
+      }
+
+      bool EEPROM::load_mesh_bank() {
+        uint16_t crc = 0, stored_crc;
+        int pos = meshes_end;
+        read_data(pos, (uint8_t*)&bedlevel.mesh_bank_temp, sizeof(bedlevel.mesh_bank_temp), &crc);
+        read_data(pos, (uint8_t*)&bedlevel.mesh_bank_auto, sizeof(bedlevel.mesh_bank_auto), &crc);
+        const uint16_t table_crc = crc;
+        read_data(pos, (uint8_t*)&stored_crc, sizeof(stored_crc), &crc);
+        return table_crc == stored_crc;
+      }
+
+      /**
+       * Blend the mesh of a slot into the active one as it is read,
+       * so no second mesh is held in RAM. The grids must match.
+       */
+      bool EEPROM::blend_mesh(const int8_t slot, const float mix) {
+        mesh_geometry_t geometry, active;
+        float mean;
+        if (!check_mesh(slot, geometry, mean)) return false;
+        mesh_geometry(active);
+        if (memcmp(&geometry, &active, sizeof(geometry))) {
+          #if ENABLED(EEPROM_CHITCHAT)
+            SERIAL_EMV("?Mesh grid differs in slot ", slot);
+          #endif
+          return false;
+        }
+        uint16_t crc = 0;
+        int pos = MESH_SLOT_POS(slot) + sizeof(geometry);
+        read_mesh(pos, MESH_Z_VALUES, &crc, mix);
+        return true;
+      }
+
+    #endif // MESH_TEMPERATURE_BANK
 
-  #endif // AUTO_BED_LEVELING_UBL
+  #endif // HAS_MESH_STORAGE
 
 #else // !EEPROM_SETTINGS
 
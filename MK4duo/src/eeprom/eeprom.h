@@ -23,6 +23,16 @@
 #ifndef EEPROM_H
 #define EEPROM_H
 
+#if HAS_MESH_STORAGE
+  /**
+   * Header of a packed mesh slot. Origin and spacing are in 0.1mm.
+   */
+  typedef struct {
+    uint8_t nx, ny;
+    int16_t x0, y0, dx, dy;
+  } mesh_geometry_t;
+#endif
+
 class EEPROM {
 
   public: /** Constructor */
@@ -37,8 +47,7 @@ class EEPROM {
 
       static bool eeprom_error;
  
-      #if ENABLED(AUTO_BED_LEVELING_UBL) // Eventually make these available if any leveling system
-                                         // That can store is enabled
+      #if HAS_MESH_STORAGE
         static int meshes_begin;
         const static int meshes_end = E2END - 128; // 128 is a placeholder for the size of the MAT; the MAT will always
                                                    // live at the very end of the eeprom
@@ -54,13 +63,24 @@ class EEPROM {
     #if ENABLED(EEPROM_SETTINGS)
       static bool Load_Settings();
 
-      #if ENABLED(AUTO_BED_LEVELING_UBL) // Eventually make these available if any leveling system
-                                         // That can store is enabled
+      #if HAS_MESH_STORAGE
         FORCE_INLINE static int get_start_of_meshes() { return meshes_begin; }
         FORCE_INLINE static int get_end_of_meshes() { return meshes_end; }
         static int calc_num_meshes();
-        static void store_mesh(int8_t slot);
-        static void load_mesh(int8_t slot, void *into = 0);
+        static bool store_mesh(const int8_t slot);
+        static bool load_mesh(const int8_t slot, void *into = 0);
+        static bool clear_mesh(const int8_t slot);
+        static bool check_mesh(const int8_t slot, mesh_geometry_t &geometry, float &mean);
+
+        #if ENABLED(MESH_TEMPERATURE_BANK)
+          /**
+           * The bank table (slot temperature tags) lives in
+           * the space reserved for the MAT after meshes_end.
+           */
+          static void store_mesh_bank();
+          static bool load_mesh_bank();
+          static bool blend_mesh(const int8_t slot, const float mix);
+        #endif
 
         //static void delete_mesh();    // necessary if we have a MAT
         //static void defrag_meshes();  // "
@@ -83,6 +103,14 @@ class EEPROM {
       static void write_data(int &pos, const uint8_t *value, uint16_t size, uint16_t *crc);
       static void read_data(int &pos, uint8_t *value, uint16_t size, uint16_t *crc);
       static void crc16(uint16_t *crc, const void * const data, uint16_t cnt);
+
+      #if ENABLED(AUTO_BED_LEVELING_UBL) || ENABLED(AUTO_BED_LEVELING_BILINEAR)
+        static void write_mesh(int &pos, const float z[][GRID_MAX_POINTS_Y], uint16_t *crc);
+        static void read_mesh(int &pos, float z[][GRID_MAX_POINTS_Y], uint16_t *crc, const float mix=1.0);
+      #endif
+      #if HAS_MESH_STORAGE
+        static void mesh_geometry(mesh_geometry_t &geometry);
+      #endif
     #endif
 
 };
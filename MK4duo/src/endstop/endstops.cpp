@@ -324,6 +324,11 @@ void Endstops::clamp_to_software_endstops(float target[XYZ]) {
 
     mechanics.workspace_offset[axis] = offs;
 
+    #if ABL_PLANAR
+      // The compiled leveling transform folds in the workspace offset
+      bedlevel.refresh_correction();
+    #endif
+
     #if ENABLED(DUAL_X_CARRIAGE)
       if (axis == X_AXIS) {
 
@@ -39,6 +39,12 @@
 
   #if ABL_PLANAR
     matrix_3x3 Bedlevel::matrix; // Transform to compensate for bed level
+    float Bedlevel::level_fwd[XYZ][XYZ + 1] = {
+            { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }
+          },
+          Bedlevel::level_inv[XYZ][XYZ + 1] = {
+            { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }
+          };
   #endif
 
   #if ENABLED(ENABLE_LEVELING_FADE_HEIGHT)
@@ -64,6 +70,21 @@
     const bool Bedlevel::g29_in_progress = false;
   #endif
 
+  #if ENABLED(MESH_TEMPERATURE_BANK)
+    int16_t   Bedlevel::mesh_bank_temp[MESH_BANK_SLOTS] = { 0 };
+    bool      Bedlevel::mesh_bank_auto = true;
+    int8_t    Bedlevel::mesh_bank_lo = -1,
+              Bedlevel::mesh_bank_hi = -1;
+    int16_t   Bedlevel::mesh_bank_target = 0;
+    uint16_t  Bedlevel::mesh_bank_sum = 0;
+
+    #if ENABLED(AUTO_BED_LEVELING_UBL)
+      #define MESH_BANK_Z ubl.z_values
+    #else
+      #define MESH_BANK_Z z_values
+    #endif
+  #endif
+
   #if PLANNER_LEVELING
 
     /**
@@ -111,15 +132,10 @@
 
       #elif ABL_PLANAR
 
-        float dx = RAW_X_POSITION(lx) - (X_TILT_FULCRUM),
-              dy = RAW_Y_POSITION(ly) - (Y_TILT_FULCRUM),
-              dz = RAW_Z_POSITION(lz);
-
-        apply_rotation_xyz(matrix, dx, dy, dz);
-
-        lx = LOGICAL_X_POSITION(dx + X_TILT_FULCRUM);
-        ly = LOGICAL_Y_POSITION(dy + Y_TILT_FULCRUM);
-        lz = LOGICAL_Z_POSITION(dz);
+        const float x = lx, y = ly, z = lz;
+        lx = level_fwd[X_AXIS][X_AXIS] * x + level_fwd[X_AXIS][Y_AXIS] * y + level_fwd[X_AXIS][Z_AXIS] * z + level_fwd[X_AXIS][XYZ];
+        ly = level_fwd[Y_AXIS][X_AXIS] * x + level_fwd[Y_AXIS][Y_AXIS] * y + level_fwd[Y_AXIS][Z_AXIS] * z + level_fwd[Y_AXIS][XYZ];
+        lz = level_fwd[Z_AXIS][X_AXIS] * x + level_fwd[Z_AXIS][Y_AXIS] * y + level_fwd[Z_AXIS][Z_AXIS] * z + level_fwd[Z_AXIS][XYZ];
 
       #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
 
@@ -191,17 +207,9 @@
 
       #elif ABL_PLANAR
 
-        matrix_3x3 inverse = matrix_3x3::transpose(matrix);
-
-        float dx = RAW_X_POSITION(logical[X_AXIS]) - (X_TILT_FULCRUM),
-              dy = RAW_Y_POSITION(logical[Y_AXIS]) - (Y_TILT_FULCRUM),
-              dz = RAW_Z_POSITION(logical[Z_AXIS]);
-
-        apply_rotation_xyz(inverse, dx, dy, dz);
-
-        logical[X_AXIS] = LOGICAL_X_POSITION(dx + X_TILT_FULCRUM);
-        logical[Y_AXIS] = LOGICAL_Y_POSITION(dy + Y_TILT_FULCRUM);
-        logical[Z_AXIS] = LOGICAL_Z_POSITION(dz);
+        const float x = logical[X_AXIS], y = logical[Y_AXIS], z = logical[Z_AXIS];
+        LOOP_XYZ(i)
+          logical[i] = level_inv[i][X_AXIS] * x + level_inv[i][Y_AXIS] * y + level_inv[i][Z_AXIS] * z + level_inv[i][XYZ];
 
       #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
 
@@ -215,6 +223,46 @@
       #endif
     }
 
+    /**
+     * Compile the correction pipeline.
+     *
+     * ABL_PLANAR: with W the workspace offset and F the tilt fulcrum,
+     * apply_leveling computes L' = M * (L - W - F) + F + W. With P = F + W
+     * this is the affine map L' = M * L + (P - M * P), and since M is a
+     * rotation its exact inverse is L = Mt * L' + (P - Mt * P).
+     */
+    void Bedlevel::refresh_correction() {
+
+      #if ABL_PLANAR
+
+        const float P[XYZ] = {
+          LOGICAL_X_POSITION(X_TILT_FULCRUM),
+          LOGICAL_Y_POSITION(Y_TILT_FULCRUM),
+          LOGICAL_Z_POSITION(0)
+        };
+
+        // matrix_3x3 stores the rotation column-major (see vector_3::apply_rotation)
+        LOOP_XYZ(i) {
+          float fwd_off = P[i], inv_off = P[i];
+          LOOP_XYZ(j) {
+            level_fwd[i][j] = matrix.matrix[3 * j + i];
+            level_inv[i][j] = matrix.matrix[3 * i + j];
+            fwd_off -= level_fwd[i][j] * P[j];
+            inv_off -= level_inv[i][j] * P[j];
+          }
+          level_fwd[i][XYZ] = fwd_off;
+          level_inv[i][XYZ] = inv_off;
+        }
+
+      #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
+
+        // Force bilinear_z_offset to re-derive its cached cell
+        const float reset[XYZ] = { -9999.999, -9999.999, 0 };
+        (void)bilinear_z_offset(reset);
+
+      #endif
+    }
+
   #endif // PLANNER_LEVELING
 
   #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
@@ -307,6 +355,7 @@
       #if ENABLED(ABL_BILINEAR_SUBDIVISION)
         virt_interpolate();
       #endif
+      refresh_correction();
     }
 
     #if ENABLED(EXTRAPOLATE_FROM_EDGE)
@@ -539,6 +588,12 @@
    */
   void Bedlevel::set_bed_leveling_enabled(const bool enable/*=true*/) {
 
+    #if ENABLED(MESH_TEMPERATURE_BANK)
+      // Build the mesh for the bed target before it is used
+      if (enable && mesh_bank_auto && !leveling_is_active())
+        mesh_bank_fill(heaters[BED_INDEX].target_temperature);
+    #endif
+
     #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
       const bool can_change = (!enable || leveling_is_valid());
     #else
@@ -577,8 +632,7 @@
 
         #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
           // Force bilinear_z_offset to re-calculate next time
-          const float reset[XYZ] = { -9999.999, -9999.999, 0 };
-          (void)bilinear_z_offset(reset);
+          refresh_correction();
         #endif
 
         // Enable or disable leveling compensation in the planner
@@ -619,6 +673,7 @@
       #endif
       #if ABL_PLANAR
         matrix.set_to_identity();
+        refresh_correction();
       #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
         bilinear_start[X_AXIS] = bilinear_start[Y_AXIS] =
         bilinear_grid_spacing[X_AXIS] = bilinear_grid_spacing[Y_AXIS] = 0;
@@ -756,4 +811,306 @@
 
   #endif // ENABLED(AUTO_BED_LEVELING_BILINEAR) || ENABLED(MESH_BED_LEVELING)
 
+  #if HAS_AUTOLEVEL && (ABL_GRID || ENABLED(AUTO_BED_LEVELING_UBL))
+
+    void Bedlevel::plan_probe_order(probe_order_t &order, const uint8_t nx, const uint8_t ny,
+                                    const float &x0, const float &y0, const float &dx, const float &dy) {
+
+      const float px = mechanics.current_position[X_AXIS] + probe.offset[X_AXIS],
+                  py = mechanics.current_position[Y_AXIS] + probe.offset[Y_AXIS];
+
+      probe_order_t o;
+      o.nx = nx;
+      o.ny = ny;
+      float best = 99999.99;
+
+      for (uint8_t v = 0; v < 8; v++) {
+        o.x_rev = TEST(v, 0);
+        o.y_rev = TEST(v, 1);
+        o.y_first = TEST(v, 2);
+
+        #if ENABLED(PROBE_Y_FIRST)
+          if (!o.y_first) continue;
+        #endif
+
+        // Travel from the probe through the points it can reach, in this order
+        float cost = 0, lx = px, ly = py;
+        for (uint16_t k = 0; k < nx * ny; k++) {
+          uint8_t ix, iy;
+          probe_order_point(o, k, ix, iy);
+          const float x = x0 + ix * dx, y = y0 + iy * dy;
+          if (!mechanics.position_is_reachable_by_probe_xy(x, y)) continue;
+          cost += HYPOT(x - lx, y - ly);
+          lx = x;
+          ly = y;
+        }
+
+        if (cost < best) {
+          best = cost;
+          order = o;
+        }
+      }
+    }
+
+    void Bedlevel::probe_order_point(const probe_order_t &order, const uint16_t k, uint8_t &ix, uint8_t &iy) {
+      const uint8_t n_in  = order.y_first ? order.ny : order.nx,
+                    n_out = order.y_first ? order.nx : order.ny;
+      uint8_t out = k / n_in, in = k % n_in;
+      if (out & 1) in = n_in - 1 - in;  // zag
+      if (order.y_first ? order.y_rev : order.x_rev) in = n_in - 1 - in;
+      if (order.y_first ? order.x_rev : order.y_rev) out = n_out - 1 - out;
+      if (order.y_first) { ix = out; iy = in; }
+      else               { ix = in; iy = out; }
+    }
+
+  #endif
+
+  #if ENABLED(PROBE_BED_TEMP_BAND)
+
+    /**
+     * Hold probing until the bed is within PROBE_BED_TEMP_BAND of its
+     * target. Heating carries on to the target while the bed is probed.
+     */
+    void Bedlevel::wait_for_bed_band() {
+      #define BED_IN_BAND() (heaters[BED_INDEX].target_temperature <= 0 || heaters[BED_INDEX].current_temperature >= heaters[BED_INDEX].target_temperature - (PROBE_BED_TEMP_BAND))
+
+      if (BED_IN_BAND()) return;
+
+      SERIAL_LM(ECHO, "Probing when bed is within " STRINGIFY(PROBE_BED_TEMP_BAND) "C of target");
+
+      #if DISABLED(BUSY_WHILE_HEATING)
+        KEEPALIVE_STATE(NOT_BUSY);
+      #endif
+
+      thermalManager.wait_for_heatup = true;
+      millis_t next_temp_ms = 0;
+
+      while (thermalManager.wait_for_heatup && !BED_IN_BAND()) {
+        const millis_t now = millis();
+        if (ELAPSED(now, next_temp_ms)) {
+          next_temp_ms = now + 1000UL;
+          thermalManager.print_heaterstates();
+          SERIAL_EOL();
+        }
+        printer.idle();
+        commands.refresh_cmd_timeout();
+      }
+
+      #if DISABLED(BUSY_WHILE_HEATING)
+        KEEPALIVE_STATE(IN_HANDLER);
+      #endif
+    }
+
+  #endif // PROBE_BED_TEMP_BAND
+
+  #if HAS_MESH_STORAGE
+
+    bool Bedlevel::mesh_slot_save(const int8_t slot
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        , const int16_t temp
+      #endif
+    ) {
+      if (!eeprom.store_mesh(slot)) return false;
+      #if ENABLED(AUTO_BED_LEVELING_UBL)
+        ubl.state.storage_slot = slot;
+      #endif
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        if (slot < MESH_BANK_SLOTS) {
+          mesh_bank_temp[slot] = temp;
+          eeprom.store_mesh_bank();
+        }
+        mesh_bank_mark(slot);
+      #endif
+      return true;
+    }
+
+    /**
+     * Load a slot by hand. With the bank automatic selection is
+     * turned off so that the next M190 doesn't replace the mesh.
+     */
+    bool Bedlevel::mesh_slot_load(const int8_t slot) {
+      const bool level_active = leveling_is_active();
+      if (level_active) set_bed_leveling_enabled(false);
+
+      const bool ok = eeprom.load_mesh(slot);
+      if (ok) {
+        #if ENABLED(AUTO_BED_LEVELING_UBL)
+          ubl.state.storage_slot = slot;
+        #else
+          refresh_bed_level();
+        #endif
+        #if ENABLED(MESH_TEMPERATURE_BANK)
+          mesh_bank_auto = false;
+          mesh_bank_mark(slot);
+        #endif
+      }
+
+      if (level_active) set_bed_leveling_enabled(true);
+      return ok;
+    }
+
+    bool Bedlevel::mesh_slot_clear(const int8_t slot) {
+      if (!eeprom.clear_mesh(slot)) return false;
+      #if ENABLED(AUTO_BED_LEVELING_UBL)
+        if (ubl.state.storage_slot == slot) ubl.state.storage_slot = -1;
+      #endif
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        if (slot < MESH_BANK_SLOTS) {
+          mesh_bank_temp[slot] = 0;
+          eeprom.store_mesh_bank();
+        }
+        if (mesh_bank_lo == slot || mesh_bank_hi == slot) mesh_bank_mark(-1);
+      #endif
+      return true;
+    }
+
+    void Bedlevel::mesh_slot_report() {
+      const int8_t slots = eeprom.calc_num_meshes();
+      for (int8_t s = 0; s < slots; s++) {
+        mesh_geometry_t geometry;
+        float mean;
+        SERIAL_SMV(ECHO, "Slot ", s);
+        if (eeprom.check_mesh(s, geometry, mean)) {
+          SERIAL_MV(" mean Z ", mean, 3);
+          #if ENABLED(MESH_TEMPERATURE_BANK)
+            if (s < MESH_BANK_SLOTS && mesh_bank_temp[s] > 0)
+              SERIAL_MV(" bed ", mesh_bank_temp[s]);
+          #endif
+          SERIAL_EOL();
+        }
+        else
+          SERIAL_EM(" empty");
+      }
+
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        SERIAL_SM(ECHO, "Active mesh: ");
+        if (mesh_bank_checksum() != mesh_bank_sum)
+          SERIAL_MSG("modified");
+        else if (mesh_bank_lo < 0)
+          SERIAL_MSG("not from bank");
+        else if (mesh_bank_lo == mesh_bank_hi)
+          SERIAL_MV("slot ", mesh_bank_lo);
+        else {
+          SERIAL_MV("slots ", mesh_bank_lo);
+          SERIAL_MV("-", mesh_bank_hi);
+        }
+        if (mesh_bank_target > 0) SERIAL_MV(" bed ", mesh_bank_target);
+        SERIAL_EOL();
+
+        SERIAL_LMT(ECHO, "Auto select: ", mesh_bank_auto ? "On" : "Off");
+      #elif ENABLED(AUTO_BED_LEVELING_UBL)
+        SERIAL_LMV(ECHO, "Active slot: ", ubl.state.storage_slot);
+      #endif
+    }
+
+  #endif // HAS_MESH_STORAGE
+
+  #if ENABLED(MESH_TEMPERATURE_BANK)
+
+    int8_t Bedlevel::mesh_bank_slots() {
+      return min(MESH_BANK_SLOTS, eeprom.calc_num_meshes());
+    }
+
+    void Bedlevel::mesh_bank_reset() {
+      ZERO(mesh_bank_temp);
+      mesh_bank_auto = true;
+    }
+
+    /**
+     * Record the active mesh as an unmodified copy of slot (-1 = not from the bank)
+     */
+    void Bedlevel::mesh_bank_mark(const int8_t slot) {
+      mesh_bank_lo = mesh_bank_hi = slot;
+      mesh_bank_target = WITHIN(slot, 0, MESH_BANK_SLOTS - 1) ? mesh_bank_temp[slot] : 0;
+      mesh_bank_sum = mesh_bank_checksum();
+    }
+
+    /**
+     * Called when M190 is done. Swap in the mesh for the new
+     * bed target, re-enabling leveling if it was active so
+     * the current position stays consistent.
+     */
+    void Bedlevel::mesh_bank_select() {
+      int8_t lo, hi;
+      if (!mesh_bank_auto || !mesh_bank_pending(heaters[BED_INDEX].target_temperature, lo, hi)) return;
+
+      if (leveling_is_active()) {
+        set_bed_leveling_enabled(false);
+        set_bed_leveling_enabled(true);   // Enabling fills the mesh
+      }
+      else
+        mesh_bank_fill(heaters[BED_INDEX].target_temperature);
+    }
+
+    /**
+     * Find the tagged slots bracketing temp. lo and hi are the same
+     * slot when temp matches a tag or lies outside the tagged range.
+     * Return true if that differs from the mesh currently in use.
+     */
+    bool Bedlevel::mesh_bank_pending(const int16_t temp, int8_t &lo, int8_t &hi) {
+      if (temp <= 0) return false;
+
+      lo = hi = -1;
+      const int8_t slots = mesh_bank_slots();
+      for (int8_t s = 0; s < slots; s++) {
+        const int16_t t = mesh_bank_temp[s];
+        if (t <= 0) continue;
+        if (t <= temp && (lo < 0 || t > mesh_bank_temp[lo])) lo = s;
+        if (t >= temp && (hi < 0 || t < mesh_bank_temp[hi])) hi = s;
+      }
+
+      if (lo < 0) lo = hi;
+      else if (hi < 0 || mesh_bank_temp[lo] == temp) hi = lo;
+      if (lo < 0) return false;
+
+      return lo != mesh_bank_lo || hi != mesh_bank_hi || (lo != hi && temp != mesh_bank_target);
+    }
+
+    /**
+     * Build the mesh for temp from the bank. Leveling must be off.
+     * A mesh probed or edited since the bank last wrote it is kept
+     * until it is saved with M323 S or replaced with M323 L.
+     */
+    void Bedlevel::mesh_bank_fill(const int16_t temp) {
+      int8_t lo, hi;
+      if (!mesh_bank_pending(temp, lo, hi)) return;
+
+      if (mesh_bank_checksum() != mesh_bank_sum) {
+        SERIAL_LM(ECHO, "Mesh modified, keeping it. Save with M323 S");
+        return;
+      }
+
+      if (!eeprom.load_mesh(lo)) return;
+
+      // The upper mesh is blended in point by point as it is read
+      if (hi != lo && !eeprom.blend_mesh(hi, float(temp - mesh_bank_temp[lo]) / float(mesh_bank_temp[hi] - mesh_bank_temp[lo])))
+        return;
+
+      #if ENABLED(AUTO_BED_LEVELING_UBL)
+        ubl.state.storage_slot = lo == hi ? lo : -1;  // Never let M500 overwrite a slot with a blend
+      #else
+        refresh_bed_level();
+      #endif
+
+      mesh_bank_lo = lo;
+      mesh_bank_hi = hi;
+      mesh_bank_target = temp;
+      mesh_bank_sum = mesh_bank_checksum();
+
+      SERIAL_SMV(ECHO, "Mesh for bed ", temp);
+      SERIAL_MV(" from slot ", lo);
+      if (hi != lo) SERIAL_MV("-", hi);
+      SERIAL_EOL();
+    }
+
+    uint16_t Bedlevel::mesh_bank_checksum() {
+      const uint8_t *p = (const uint8_t*)&MESH_BANK_Z;
+      uint16_t sum = 0;
+      for (uint16_t i = 0; i < sizeof(MESH_BANK_Z); i++)
+        sum = ((sum << 1) | (sum >> 15)) ^ p[i];
+      return sum;
+    }
+
+  #endif // MESH_TEMPERATURE_BANK
+
 #endif // HAS_LEVELING
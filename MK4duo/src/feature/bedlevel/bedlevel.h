@@ -67,6 +67,17 @@
 
   #endif
 
+  #if HAS_AUTOLEVEL && (ABL_GRID || ENABLED(AUTO_BED_LEVELING_UBL))
+    /**
+     * Visiting order of a probe grid: a serpentine along
+     * X rows or Y columns, starting from one of the corners.
+     */
+    typedef struct {
+      uint8_t nx, ny;
+      bool    y_first, x_rev, y_rev;
+    } probe_order_t;
+  #endif
+
   class Bedlevel {
 
     public: /** Constructor */
@@ -99,8 +110,30 @@
         static const bool g29_in_progress;
       #endif
 
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        static int16_t  mesh_bank_temp[MESH_BANK_SLOTS];  // Bed temperature each slot was probed at, 0 = empty
+        static bool     mesh_bank_auto;                   // Select the mesh after M190 and when leveling is enabled
+      #endif
+
     private: /** Private Parameters */
-    
+
+      #if ABL_PLANAR
+        /**
+         * Compiled affine part of the correction pipeline.
+         * Rotation about the tilt fulcrum and the logical/raw
+         * conversions folded into one matrix-plus-offset, with
+         * its exact inverse. Rebuilt by refresh_correction().
+         */
+        static float  level_fwd[XYZ][XYZ + 1],
+                      level_inv[XYZ][XYZ + 1];
+      #endif
+
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        static int8_t   mesh_bank_lo, mesh_bank_hi;       // Slots blended into the active mesh, -1 = none
+        static int16_t  mesh_bank_target;                 // Bed temperature the active mesh was built for
+        static uint16_t mesh_bank_sum;                    // Checksum of the mesh as the bank left it
+      #endif
+
       #if ENABLED(AUTO_BED_LEVELING_BILINEAR) && ENABLED(ABL_BILINEAR_SUBDIVISION)
         static float  bilinear_grid_factor_virt[2],
                       z_values_virt[ABL_GRID_POINTS_VIRT_X][ABL_GRID_POINTS_VIRT_Y];
@@ -117,6 +150,13 @@
         static void apply_leveling(float &lx, float &ly, float &lz);
         static void apply_leveling(float logical[XYZ]) { apply_leveling(logical[X_AXIS], logical[Y_AXIS], logical[Z_AXIS]); }
         static void unapply_leveling(float logical[XYZ]);
+
+        /**
+         * Rebuild the precomputed correction state.
+         * Call whenever the matrix, the grid
+         * or the workspace offsets change.
+         */
+        static void refresh_correction();
       #endif
 
       #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
@@ -141,6 +181,22 @@
         #endif
       #endif
 
+      #if HAS_AUTOLEVEL && (ABL_GRID || ENABLED(AUTO_BED_LEVELING_UBL))
+        /**
+         * Pick, of the 8 serpentines from a corner along X or Y, the one
+         * with the least travel from where the probe is now through the
+         * grid points it can reach. Not a general travel planner.
+         * Point i,j is at logical x0 + i * dx, y0 + j * dy.
+         */
+        static void plan_probe_order(probe_order_t &order, const uint8_t nx, const uint8_t ny,
+                                     const float &x0, const float &y0, const float &dx, const float &dy);
+        static void probe_order_point(const probe_order_t &order, const uint16_t k, uint8_t &ix, uint8_t &iy);
+      #endif
+
+      #if ENABLED(PROBE_BED_TEMP_BAND)
+        static void wait_for_bed_band();
+      #endif
+
       static bool leveling_is_valid();
       static bool leveling_is_active();
       static void set_bed_leveling_enabled(const bool enable=true);
@@ -155,8 +211,32 @@
         static void mbl_mesh_report();
       #endif
 
+      #if HAS_MESH_STORAGE
+        static bool mesh_slot_save(const int8_t slot
+          #if ENABLED(MESH_TEMPERATURE_BANK)
+            , const int16_t temp
+          #endif
+        );
+        static bool mesh_slot_load(const int8_t slot);
+        static bool mesh_slot_clear(const int8_t slot);
+        static void mesh_slot_report();
+      #endif
+
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        static void mesh_bank_reset();
+        static void mesh_bank_mark(const int8_t slot);
+        static void mesh_bank_select();
+        static int8_t mesh_bank_slots();
+      #endif
+
     private: /** Private Function */
 
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        static bool mesh_bank_pending(const int16_t temp, int8_t &lo, int8_t &hi);
+        static void mesh_bank_fill(const int16_t temp);
+        static uint16_t mesh_bank_checksum();
+      #endif
+
       #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
         /**
          * Extrapolate a single point from its neighbors
@@ -589,7 +589,10 @@
         return;
       }
 
-      eeprom.load_mesh(g29_storage_slot);
+      if (!eeprom.load_mesh(g29_storage_slot)) {
+        SERIAL_EM("?Mesh slot empty or corrupt.");
+        return;
+      }
       state.storage_slot = g29_storage_slot;
 
       SERIAL_EM("Done.");
@@ -630,7 +633,10 @@
         goto LEAVE;
       }
 
-      eeprom.store_mesh(g29_storage_slot);
+      if (!eeprom.store_mesh(g29_storage_slot)) {
+        SERIAL_EM("?Error writing mesh.");
+        goto LEAVE;
+      }
       state.storage_slot = g29_storage_slot;
 
       SERIAL_EM("Done.");
@@ -766,6 +772,18 @@
 
     uint16_t max_iterations = GRID_MAX_POINTS;
 
+    #if ENABLED(PROBE_BED_TEMP_BAND)
+      bedlevel.wait_for_bed_band();
+    #endif
+
+    // Unless spreading the points out (U), visit them in the order with the least travel
+    probe_order_t order;
+    uint16_t order_index = 0;
+    if (!close_or_far)
+      bedlevel.plan_probe_order(order, GRID_MAX_POINTS_X, GRID_MAX_POINTS_Y,
+                                LOGICAL_X_POSITION(UBL_MESH_MIN_X), LOGICAL_Y_POSITION(UBL_MESH_MIN_Y),
+                                MESH_X_DIST, MESH_Y_DIST);
+
     do {
       #if ENABLED(NEWPANEL)
         if (ubl_lcd_clicked()) {
@@ -780,7 +798,20 @@
         }
       #endif
 
-      location = find_closest_mesh_point_of_type(INVALID, lx, ly, USE_PROBE_AS_REFERENCE, NULL, close_or_far);
+      if (close_or_far)
+        location = find_closest_mesh_point_of_type(INVALID, lx, ly, USE_PROBE_AS_REFERENCE, NULL, true);
+      else {
+        location.x_index = location.y_index = -1;
+        while (order_index < GRID_MAX_POINTS) {
+          uint8_t ix, iy;
+          bedlevel.probe_order_point(order, order_index++, ix, iy);
+          if (isnan(z_values[ix][iy]) && mechanics.position_is_reachable_by_probe_raw_xy(mesh_index_to_xpos(ix), mesh_index_to_ypos(iy))) {
+            location.x_index = ix;
+            location.y_index = iy;
+            break;
+          }
+        }
+      }
 
       if (location.x_index >= 0) {    // mesh point found and is reachable by probe
         const float rawx = mesh_index_to_xpos(location.x_index),
@@ -1327,7 +1358,10 @@
     }
 
     float tmp_z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
-    eeprom.load_mesh(g29_storage_slot, &tmp_z_values);
+    if (!eeprom.load_mesh(g29_storage_slot, &tmp_z_values)) {
+      SERIAL_EM("?Mesh slot empty or corrupt.");
+      return;
+    }
 
     SERIAL_MV("Subtracting mesh in slot ", g29_storage_slot);
     SERIAL_EM(" from current mesh.");
@@ -177,268 +177,87 @@
     }
 
     /**
-     * If we get here, we are processing a move that crosses at least one Mesh Line. We will check
-     * for the simple case of just crossing X or just crossing Y Mesh Lines after we get all the details
-     * of the move figured out. We can process the easy case of just crossing an X or Y Mesh Line with less
-     * computation and in fact most lines are of this nature. We will check for that in the following
-     * blocks of code:
+     * If we get here, the move crosses at least one Mesh Line. Walk the crossings in order,
+     * DDA style: keep the parametric position (0..1 along the move) of the next X and the
+     * next Y Mesh Line and advance whichever comes first by a precomputed step. This needs
+     * a single divide per axis for the whole move, and no cell index lookups.
      */
 
     const float dx = end[X_AXIS] - start[X_AXIS],
-                dy = end[Y_AXIS] - start[Y_AXIS];
+                dy = end[Y_AXIS] - start[Y_AXIS],
+                dz = end[Z_AXIS] - start[Z_AXIS],
+                de = end[E_AXIS] - start[E_AXIS];
 
-    const int left_flag = dx < 0.0 ? 1 : 0,
-              down_flag = dy < 0.0 ? 1 : 0;
+    const int8_t dxi = cell_start_xi == cell_dest_xi ? 0 : dx < 0.0 ? -1 : 1,
+                 dyi = cell_start_yi == cell_dest_yi ? 0 : dy < 0.0 ? -1 : 1;
 
-    const float adx = left_flag ? -dx : dx,
-                ady = down_flag ? -dy : dy;
+    int8_t  current_xi = cell_start_xi,                   // Cell the move is in
+            current_yi = cell_start_yi;
 
-    const int dxi = cell_start_xi == cell_dest_xi ? 0 : left_flag ? -1 : 1,
-              dyi = cell_start_yi == cell_dest_yi ? 0 : down_flag ? -1 : 1;
+    uint8_t xi_cnt = dxi ? abs(cell_dest_xi - cell_start_xi) : 0,
+            yi_cnt = dyi ? abs(cell_dest_yi - cell_start_yi) : 0;
 
-    /**
-     * Compute the scaling factor for the extruder for each partial move.
-     * We need to watch out for zero length moves because it will cause us to
-     * have an infinate scaling factor. We are stuck doing a floating point
-     * divide to get our scaling factor, but after that, we just multiply by this
-     * number. We also pick our scaling factor based on whether the X or Y
-     * component is larger. We use the biggest of the two to preserve precision.
-     */
-
-    const bool use_x_dist = adx > ady;
-
-    float on_axis_distance = use_x_dist ? dx : dy,
-          e_position = end[E_AXIS] - start[E_AXIS],
-          z_position = end[Z_AXIS] - start[Z_AXIS];
-
-    const float e_normalized_dist = e_position / on_axis_distance,
-                z_normalized_dist = z_position / on_axis_distance;
-
-    int current_xi = cell_start_xi,
-        current_yi = cell_start_yi;
-
-    const float m = dy / dx,
-                c = start[Y_AXIS] - m * start[X_AXIS];
+    float next_tx = 0.0, next_ty = 0.0,                  // Position of the next X and Y Mesh Lines
+          step_tx = 0.0, step_ty = 0.0;                  // Distance between Mesh Lines
 
-    const bool inf_normalized_flag = (isinf(e_normalized_dist) != 0),
-               inf_m_flag = (isinf(m) != 0);
-    /**
-     * This block handles vertical lines. These are lines that stay within the same
-     * X Cell column. They do not need to be perfectly vertical. They just can
-     * not cross into another X Cell column.
-     */
-    if (dxi == 0) {       // Check for a vertical line
-      current_yi += down_flag;  // Line is heading down, we just want to go to the bottom
-      while (current_yi != cell_dest_yi + down_flag) {
-        current_yi += dyi;
-        const float next_mesh_line_y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi));
-
-        /**
-         * if the slope of the line is infinite, we won't do the calculations
-         * else, we know the next X is the same so we can recover and continue!
-         * Calculate X at the next Y mesh line
-         */
-        const float x = inf_m_flag ? start[X_AXIS] : (next_mesh_line_y - c) / m;
-
-        float z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi, current_yi);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        const float y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi));
-
-        /**
-         * Without this check, it is possible for the algorithm to generate a zero length move in the case
-         * where the line is heading down and it is starting right on a Mesh Line boundary. For how often that
-         * happens, it might be best to remove the check and always 'schedule' the move because
-         * the planner._buffer_line() routine will filter it if that happens.
-         */
-        if (y != start[Y_AXIS]) {
-          if (!inf_normalized_flag) {
-            on_axis_distance = use_x_dist ? x - start[X_AXIS] : y - start[Y_AXIS];
-            e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
-            z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-          }
-          else {
-            e_position = end[E_AXIS];
-            z_position = end[Z_AXIS];
-          }
-
-          planner._buffer_line(x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
-        } //else printf("FIRST MOVE PRUNED  ");
-      }
-
-      if (g26_debug_flag)
-        debug_current_and_destination(PSTR("vertical move done in ubl.line_to_destination()"));
-
-      //
-      // Check if we are at the final mechanics.destination. Usually, we won't be, but if it is on a Y Mesh Line, we are done.
-      //
-      if (mechanics.current_position[X_AXIS] != end[X_AXIS] || mechanics.current_position[Y_AXIS] != end[Y_AXIS])
-        goto FINAL_MOVE;
-
-      mechanics.set_current_to_destination();
-      return;
+    if (dxi) {
+      const float inv_dx = 1.0 / dx;
+      next_tx = (LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi + (dxi > 0))) - start[X_AXIS]) * inv_dx;
+      step_tx = (MESH_X_DIST) * FABS(inv_dx);
+    }
+    if (dyi) {
+      const float inv_dy = 1.0 / dy;
+      next_ty = (LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi + (dyi > 0))) - start[Y_AXIS]) * inv_dy;
+      step_ty = (MESH_Y_DIST) * FABS(inv_dy);
     }
 
-    /**
-     *
-     * This block handles horizontal lines. These are lines that stay within the same
-     * Y Cell row. They do not need to be perfectly horizontal. They just can
-     * not cross into another Y Cell row.
-     *
-     */
-
-    if (dyi == 0) {             // Check for a horizontal line
-      current_xi += left_flag;  // Line is heading left, we just want to go to the left
-                                // edge of this cell for the first move.
-      while (current_xi != cell_dest_xi + left_flag) {
-        current_xi += dxi;
-        const float next_mesh_line_x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi)),
-                    y = m * next_mesh_line_x + c;   // Calculate Y at the next X mesh line
-
-        float z0 = z_correction_for_y_on_vertical_mesh_line(y, current_xi, current_yi);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        const float x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi));
-
-        /**
-         * Without this check, it is possible for the algorithm to generate a zero length move in the case
-         * where the line is heading left and it is starting right on a Mesh Line boundary. For how often
-         * that happens, it might be best to remove the check and always 'schedule' the move because
-         * the planner._buffer_line() routine will filter it if that happens.
-         */
-        if (x != start[X_AXIS]) {
-          if (!inf_normalized_flag) {
-            on_axis_distance = use_x_dist ? x - start[X_AXIS] : y - start[Y_AXIS];
-            e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;  // is based on X or Y because this is a horizontal move
-            z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-          }
-          else {
-            e_position = end[E_AXIS];
-            z_position = end[Z_AXIS];
-          }
-
-          planner._buffer_line(x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
-        } //else printf("FIRST MOVE PRUNED  ");
-      }
-
-      if (g26_debug_flag)
-        debug_current_and_destination(PSTR("horizontal move done in ubl.line_to_destination()"));
-
-      if (mechanics.current_position[X_AXIS] != end[X_AXIS] || mechanics.current_position[Y_AXIS] != end[Y_AXIS])
-        goto FINAL_MOVE;
+    const float fade_scaling_factor = fade_scaling_factor_for_z(end[Z_AXIS]);
 
-      mechanics.set_current_to_destination();
-      return;
-    }
+    while (xi_cnt || yi_cnt) {
 
-    /**
-     *
-     * This block handles the generic case of a line crossing both X and Y Mesh lines.
-     *
-     */
+      float t, x, y, z0;
 
-    int xi_cnt = cell_start_xi - cell_dest_xi,
-        yi_cnt = cell_start_yi - cell_dest_yi;
-
-    if (xi_cnt < 0) xi_cnt = -xi_cnt;
-    if (yi_cnt < 0) yi_cnt = -yi_cnt;
-
-    current_xi += left_flag;
-    current_yi += down_flag;
-
-    while (xi_cnt > 0 || yi_cnt > 0) {
-
-      const float next_mesh_line_x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi + dxi)),
-                  next_mesh_line_y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi + dyi)),
-                  y = m * next_mesh_line_x + c,   // Calculate Y at the next X mesh line
-                  x = (next_mesh_line_y - c) / m; // Calculate X at the next Y mesh line
-                                                  // (No need to worry about m being zero.
-                                                  //  If that was the case, it was already detected
-                                                  //  as a vertical line move above.)
-
-      if (left_flag == (x > next_mesh_line_x)) { // Check if we hit the Y line first
-        // Yes!  Crossing a Y Mesh Line next
-        float z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi - left_flag, current_yi + dyi);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        if (!inf_normalized_flag) {
-          on_axis_distance = use_x_dist ? x - start[X_AXIS] : next_mesh_line_y - start[Y_AXIS];
-          e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
-          z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-        }
-        else {
-          e_position = end[E_AXIS];
-          z_position = end[Z_AXIS];
-        }
-        planner._buffer_line(x, next_mesh_line_y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
+      if (yi_cnt && (!xi_cnt || next_ty < next_tx)) {
+        // Crossing a Y Mesh Line next
+        const int8_t line_yi = current_yi + (dyi > 0);
+        t = next_ty;
+        x = start[X_AXIS] + dx * t;
+        y = LOGICAL_Y_POSITION(mesh_index_to_ypos(line_yi));
+        z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi, line_yi);
         current_yi += dyi;
+        next_ty += step_ty;
         yi_cnt--;
       }
       else {
-        // Yes!  Crossing a X Mesh Line next
-        float z0 = z_correction_for_y_on_vertical_mesh_line(y, current_xi + dxi, current_yi - down_flag);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        if (!inf_normalized_flag) {
-          on_axis_distance = use_x_dist ? next_mesh_line_x - start[X_AXIS] : y - start[Y_AXIS];
-          e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
-          z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-        }
-        else {
-          e_position = end[E_AXIS];
-          z_position = end[Z_AXIS];
-        }
-
-        planner._buffer_line(next_mesh_line_x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
+        // Crossing an X Mesh Line next
+        const int8_t line_xi = current_xi + (dxi > 0);
+        t = next_tx;
+        x = LOGICAL_X_POSITION(mesh_index_to_xpos(line_xi));
+        y = start[Y_AXIS] + dy * t;
+        z0 = z_correction_for_y_on_vertical_mesh_line(y, line_xi, current_yi);
         current_xi += dxi;
+        next_tx += step_tx;
         xi_cnt--;
       }
 
-      if (xi_cnt < 0 || yi_cnt < 0) break; // we've gone too far, so exit the loop and move on to FINAL_MOVE
+      z0 *= fade_scaling_factor;
+
+      /**
+       * If part of the Mesh is undefined, it will show up as NAN
+       * in z_values[][] and propagate through the
+       * calculations. If our correction is NAN, we throw it out
+       * because part of the Mesh is undefined and we don't have the
+       * information we need to complete the height correction.
+       */
+      if (isnan(z0)) z0 = 0.0;
+
+      // A move starting right on a Mesh Line would give a zero length first piece
+      if (t > 0.0)
+        planner._buffer_line(x, y, start[Z_AXIS] + dz * t + z0 + state.z_offset, start[E_AXIS] + de * t, feed_rate, extruder);
     }
 
     if (g26_debug_flag)
-      debug_current_and_destination(PSTR("generic move done in ubl.line_to_destination()"));
+      debug_current_and_destination(PSTR("mesh lines done in ubl.line_to_destination()"));
 
     if (mechanics.current_position[X_AXIS] != end[X_AXIS] || mechanics.current_position[Y_AXIS] != end[Y_AXIS])
       goto FINAL_MOVE;
@@ -536,20 +355,25 @@
       seg_rz += seg_dz;
       seg_le += seg_de;
 
-      for(;;) {  // for each mesh cell encountered during the move
+      // Locate the first cell once. After that the walk steps to neighbouring cells.
+      // Points outside the mesh grid (in the MESH_INSET perimeter) stay in the edge
+      // cell, whose bilinear interpolation extrapolates, so the margin costs nothing extra.
 
-        // Compute mesh cell invariants that remain constant for all segments within cell.
-        // Note for cell index, if point is outside the mesh grid (in MESH_INSET perimeter)
-        // the bilinear interpolation from the adjacent cell within the mesh will still work.
-        // Inner loop will exit each time (because out of cell bounds) but will come back
-        // in top of loop and again re-find same adjacent cell and use it, just less efficient
-        // for mesh inset area.
+      int8_t cell_xi = (seg_rx - (UBL_MESH_MIN_X)) * (1.0 / (MESH_X_DIST)),
+             cell_yi = (seg_ry - (UBL_MESH_MIN_Y)) * (1.0 / (MESH_Y_DIST));
+
+      cell_xi = constrain(cell_xi, 0, (GRID_MAX_POINTS_X) - 2);
+      cell_yi = constrain(cell_yi, 0, (GRID_MAX_POINTS_Y) - 2);
+
+      for(;;) {  // for each mesh cell encountered during the move
 
-        int8_t cell_xi = (seg_rx - (UBL_MESH_MIN_X)) * (1.0 / (MESH_X_DIST)),
-               cell_yi = (seg_ry - (UBL_MESH_MIN_Y)) * (1.0 / (MESH_X_DIST));
+        // Step across as many mesh lines as the last segment crossed
+        while (cell_xi > 0 && seg_rx < mesh_index_to_xpos(cell_xi)) cell_xi--;
+        while (cell_xi < (GRID_MAX_POINTS_X) - 2 && seg_rx > mesh_index_to_xpos(cell_xi + 1)) cell_xi++;
+        while (cell_yi > 0 && seg_ry < mesh_index_to_ypos(cell_yi)) cell_yi--;
+        while (cell_yi < (GRID_MAX_POINTS_Y) - 2 && seg_ry > mesh_index_to_ypos(cell_yi + 1)) cell_yi++;
 
-        cell_xi = constrain(cell_xi, 0, (GRID_MAX_POINTS_X) - 1);
-        cell_yi = constrain(cell_yi, 0, (GRID_MAX_POINTS_Y) - 1);
+        // Compute mesh cell invariants that remain constant for all segments within cell.
 
         const float x0 = mesh_index_to_xpos(cell_xi),   // 64 byte table lookup avoids mul+add
                     y0 = mesh_index_to_ypos(cell_yi);
@@ -616,9 +440,10 @@
           cx += seg_dx;
           cy += seg_dy;
 
-          if (!WITHIN(cx, 0, MESH_X_DIST) || !WITHIN(cy, 0, MESH_Y_DIST)) {  // done within this cell, break to next
-            break;
-          }
+          // Done within this cell when a mesh line with a cell beyond it is crossed
+          if ( (cx < 0 && cell_xi > 0) || (cx > (MESH_X_DIST) && cell_xi < (GRID_MAX_POINTS_X) - 2)
+            || (cy < 0 && cell_yi > 0) || (cy > (MESH_Y_DIST) && cell_yi < (GRID_MAX_POINTS_Y) - 2)
+          ) break;
 
           // Next segment still within same mesh cell, adjust the per-segment
           // slope and intercept to compute next z height.
@@ -408,6 +408,10 @@ inline void gcode_G29(void) {
     }
 
     #if HAS_BED_PROBE
+      #if ENABLED(PROBE_BED_TEMP_BAND)
+        if (!faux) bedlevel.wait_for_bed_band();
+      #endif
+
       // Deploy the probe. Probe will raise if needed.
       if (DEPLOY_PROBE()) {
         bedlevel.abl_enabled = abl_should_enable;
@@ -638,72 +642,61 @@ inline void gcode_G29(void) {
 
     #if ABL_GRID
 
-      bool zig = PR_OUTER_END & 1;  // Always end at RIGHT and BACK_PROBE_BED_POSITION
+      // Visit the grid in the order with the least travel
+      probe_order_t order;
+      bedlevel.plan_probe_order(order, abl_grid_points_x, abl_grid_points_y,
+                                left_probe_bed_position, front_probe_bed_position,
+                                xGridSpacing, yGridSpacing);
 
-      // Outer loop is Y with PROBE_Y_FIRST disabled
-      for (uint8_t PR_OUTER_VAR = 0; PR_OUTER_VAR < PR_OUTER_END && !isnan(measured_z); PR_OUTER_VAR++) {
+      const uint16_t grid_points = abl_grid_points_x * abl_grid_points_y;
 
-        int8_t inStart, inStop, inInc;
+      for (uint16_t k = 0; k < grid_points && !isnan(measured_z); k++) {
 
-        if (zig) { // away from origin
-          inStart = 0;
-          inStop = PR_INNER_END;
-          inInc = 1;
-        }
-        else {     // towards origin
-          inStart = PR_INNER_END - 1;
-          inStop = -1;
-          inInc = -1;
-        }
+        uint8_t xCount, yCount;
+        bedlevel.probe_order_point(order, k, xCount, yCount);
 
-        zig ^= true; // zag
+        float xBase = left_probe_bed_position + xGridSpacing * xCount,
+              yBase = front_probe_bed_position + yGridSpacing * yCount;
 
-        // Inner loop is Y with PROBE_Y_FIRST enabled
-        for (int8_t PR_INNER_VAR = inStart; PR_INNER_VAR != inStop; PR_INNER_VAR += inInc) {
-
-          float xBase = left_probe_bed_position + xGridSpacing * xCount,
-                yBase = front_probe_bed_position + yGridSpacing * yCount;
-
-          xProbe = FLOOR(xBase + (xBase < 0 ? 0 : 0.5));
-          yProbe = FLOOR(yBase + (yBase < 0 ? 0 : 0.5));
+        xProbe = FLOOR(xBase + (xBase < 0 ? 0 : 0.5));
+        yProbe = FLOOR(yBase + (yBase < 0 ? 0 : 0.5));
 
-          #if ENABLED(AUTO_BED_LEVELING_LINEAR)
-            indexIntoAB[xCount][yCount] = ++abl_probe_index; // 0...
-          #endif
+        #if ENABLED(AUTO_BED_LEVELING_LINEAR)
+          indexIntoAB[xCount][yCount] = ++abl_probe_index; // 0...
+        #endif
 
-          #if IS_KINEMATIC
-            // Avoid probing outside the round or hexagonal area
-            if (!mechanics.position_is_reachable_by_probe_xy(xProbe, yProbe)) continue;
-          #endif
+        #if IS_KINEMATIC
+          // Avoid probing outside the round or hexagonal area
+          if (!mechanics.position_is_reachable_by_probe_xy(xProbe, yProbe)) continue;
+        #endif
 
-          measured_z = faux ? 0.001 * random(-100, 101) : probe.check_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
+        measured_z = faux ? 0.001 * random(-100, 101) : probe.check_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
 
-          if (isnan(measured_z)) {
-            bedlevel.abl_enabled = abl_should_enable;
-            break;
-          }
+        if (isnan(measured_z)) {
+          bedlevel.abl_enabled = abl_should_enable;
+          break;
+        }
 
-          #if ENABLED(AUTO_BED_LEVELING_LINEAR)
+        #if ENABLED(AUTO_BED_LEVELING_LINEAR)
 
-            mean += measured_z;
-            eqnBVector[abl_probe_index] = measured_z;
-            eqnAMatrix[abl_probe_index + 0 * abl2] = xProbe;
-            eqnAMatrix[abl_probe_index + 1 * abl2] = yProbe;
-            eqnAMatrix[abl_probe_index + 2 * abl2] = 1;
+          mean += measured_z;
+          eqnBVector[abl_probe_index] = measured_z;
+          eqnAMatrix[abl_probe_index + 0 * abl2] = xProbe;
+          eqnAMatrix[abl_probe_index + 1 * abl2] = yProbe;
+          eqnAMatrix[abl_probe_index + 2 * abl2] = 1;
 
-            incremental_LSF(&lsf_results, xProbe, yProbe, measured_z);
+          incremental_LSF(&lsf_results, xProbe, yProbe, measured_z);
 
-          #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
+        #elif ENABLED(AUTO_BED_LEVELING_BILINEAR)
 
-            bedlevel.z_values[xCount][yCount] = measured_z + zoffset;
+          bedlevel.z_values[xCount][yCount] = measured_z + zoffset;
 
-          #endif
+        #endif
 
-          abl_should_enable = false;
-          printer.idle();
+        abl_should_enable = false;
+        printer.idle();
 
-        } // inner
-      } // outer
+      } // grid points
 
     #elif ENABLED(AUTO_BED_LEVELING_3POINT)
 
@@ -884,6 +877,8 @@ inline void gcode_G29(void) {
 
       // For LINEAR and 3POINT leveling correct the current position
 
+      if (!dryrun) bedlevel.refresh_correction();
+
       if (verbose_level > 0)
         bedlevel.matrix.debug("\n\nBed Level Correction Matrix:");
 
@@ -0,0 +1,80 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/**
+ * mcode
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#if HAS_MESH_STORAGE
+
+  #define CODE_M323
+
+  /**
+   * M323: Mesh storage slots
+   *
+   *       S[slot]   Save the active mesh in a slot
+   *       T[temp]   Bed temperature tag to use with S (default the bed target, or the bed temperature)
+   *       L[slot]   Load a slot (and turn automatic selection off)
+   *       C[slot]   Clear a slot
+   *       A[bool]   Automatic selection after M190 and when leveling is enabled
+   *
+   *  T and A need MESH_TEMPERATURE_BANK.
+   *  With no parameters list the slots and report the active mesh.
+   */
+  inline void gcode_M323(void) {
+
+    if (parser.seen('S')) {
+      const int8_t slot = parser.value_int();
+      #if ENABLED(MESH_TEMPERATURE_BANK)
+        int16_t temp = heaters[BED_INDEX].target_temperature;
+        if (temp <= 0) temp = heaters[BED_INDEX].current_temperature;
+        if (parser.seen('T')) temp = parser.value_celsius();
+        if (temp <= 0 || !bedlevel.mesh_slot_save(slot, temp))
+      #else
+        if (!bedlevel.mesh_slot_save(slot))
+      #endif
+          SERIAL_LMV(ER, "Invalid slot. Slots: ", eeprom.calc_num_meshes());
+    }
+    else if (parser.seen('L')) {
+      if (!bedlevel.mesh_slot_load(parser.value_int()))
+        SERIAL_LM(ER, "Mesh slot empty or corrupt");
+    }
+    else if (parser.seen('C')) {
+      if (!bedlevel.mesh_slot_clear(parser.value_int()))
+        SERIAL_LM(ER, "Invalid slot");
+    }
+
+    #if ENABLED(MESH_TEMPERATURE_BANK)
+      if (parser.seen('A')) {
+        bedlevel.mesh_bank_auto = parser.value_bool();
+        eeprom.store_mesh_bank();
+        if (bedlevel.mesh_bank_auto) bedlevel.mesh_bank_select();
+      }
+    #endif
+
+    bedlevel.mesh_slot_report();
+  }
+
+#endif // HAS_MESH_STORAGE
@@ -61,7 +61,10 @@
           return;
         }
 
-        eeprom.load_mesh(storage_slot);
+        if (!eeprom.load_mesh(storage_slot)) {
+          SERIAL_EM("?Mesh slot empty or corrupt.");
+          return;
+        }
         ubl.state.storage_slot = storage_slot;
 
       #else
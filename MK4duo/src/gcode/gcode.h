@@ -38,6 +38,7 @@
 #include "bedlevel/ubl/m49.h"             // UBL Mesh Validation
 #include "bedlevel/ubl/m420_m421.h"       // Set UBL
 #include "bedlevel/g42.h"                 // Move to mesh
+#include "bedlevel/m323.h"                // Mesh temperature bank
 
 // Calibrate Commands
 #include "calibrate/g28.h"                // Home
@@ -133,6 +134,8 @@
 #include "host/m530.h"                    // Enables explicit printing mode
 #include "host/m531.h"                    // Define filename being printed
 #include "host/m532.h"                    // Update current print state progress
+#include "host/m575.h"                    // Serial transport
+#include "host/m576.h"                    // Serial TX statistics
 
 // LCD Commands
 #include "lcd/m0_m1.h"
@@ -227,6 +230,7 @@
 // Table for G and M code
 #include "table_gcode.h"
 #include "table_mcode.h"
+#include "table_index.h"
 
 // Include m44 post define table for debugging
 #include "debug/m44_post_table.h"
@@ -30,6 +30,10 @@
 
 /**
  * M114: Report current position to host
+ *
+ *  D   Detailed report, after the moves end
+ *  R   Where the steppers are now, without waiting for the moves
+ *  S   Also report the stepper counts
  */
 inline void gcode_M114(void) {
 
@@ -38,7 +42,15 @@ inline void gcode_M114(void) {
     return;
   }
 
-  stepper.synchronize();
+  if (parser.seen('R')) {
+    mechanics.report_realtime_position();
+    return;
+  }
+
+  #if NUM_SERIAL > 1
+    if (!commands.out_of_queue)   // Report where the queued moves go without stopping them
+  #endif
+      stepper.synchronize();
   mechanics.report_current_position();
 
   if (parser.seen('S')) stepper.report_positions();
@@ -99,5 +99,26 @@ inline void gcode_M115(void) {
       SERIAL_LM(CAP, "EMERGENCY_PARSER:0");
     #endif
 
+    // ADVANCED_OK (ok N<line> P<planner free> B<queue free> L<last line>)
+    #if ENABLED(ADVANCED_OK)
+      SERIAL_LM(CAP, "ADVANCED_OK:1");
+    #else
+      SERIAL_LM(CAP, "ADVANCED_OK:0");
+    #endif
+
+    // BINARY_PROTOCOL (M575)
+    #if ENABLED(BINARY_GCODE_TRANSPORT)
+      SERIAL_LM(CAP, "BINARY_PROTOCOL:1");
+    #else
+      SERIAL_LM(CAP, "BINARY_PROTOCOL:0");
+    #endif
+
+    // SD_UPLOAD (M577)
+    #if ENABLED(SD_BINARY_UPLOAD)
+      SERIAL_LM(CAP, "SD_UPLOAD:1");
+    #else
+      SERIAL_LM(CAP, "SD_UPLOAD:0");
+    #endif
+
   #endif // EXTENDED_CAPABILITIES_REPORT
 }
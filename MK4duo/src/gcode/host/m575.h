@@ -0,0 +1,44 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * mcode
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#if ENABLED(BINARY_GCODE_TRANSPORT)
+
+  #define CODE_M575
+
+  /**
+   * M575: Serial transport
+   *
+   *  S0  ASCII lines only
+   *  S1  Binary frames accepted as well as ASCII lines
+   */
+  inline void gcode_M575(void) {
+    if (parser.seen('S')) commands.binary_mode = parser.value_bool();
+    SERIAL_LMT(ECHO, "Binary transport: ", commands.binary_mode ? "On" : "Off");
+  }
+
+#endif // BINARY_GCODE_TRANSPORT
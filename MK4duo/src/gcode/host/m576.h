@@ -0,0 +1,53 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/**
+ * mcode
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#if HAS_SERIAL_TX_STATS
+
+  #define CODE_M576
+
+  /**
+   * M576: Serial TX statistics
+   *
+   *  Report the writes that waited for room in the TX buffer, the time
+   *  they waited and the optional messages skipped while moving.
+   *
+   *  R  Reset the counters
+   */
+  inline void gcode_M576(void) {
+    SERIAL_SMV(ECHO, "TX buffer:", (int)TX_BUFFER_SIZE);
+    SERIAL_MV(" stalls:", MKSERIAL.txStalls());
+    SERIAL_MV(" stall ms:", MKSERIAL.txStallMicros() / 1000UL);
+    SERIAL_EMV(" skipped:", serial_skipped);
+    if (parser.seen('R')) {
+      MKSERIAL.txStatsReset();
+      serial_skipped = 0;
+    }
+  }
+
+#endif // HAS_SERIAL_TX_STATS
@@ -43,6 +43,15 @@
   #define CODE_M33
   #define CODE_M34
 
+  #if HAS_SD_GCODE_INFO
+    #define CODE_M36
+    #define CODE_M415
+  #endif
+
+  #if HAS_SD_PRINT_TIME
+    #define CODE_M73
+  #endif
+
   /**
    * M20: List SD card to serial output
    */
@@ -116,6 +125,28 @@
    */
   inline void gcode_M27(void) { card.printStatus(); }
 
+  #if HAS_SD_PRINT_TIME
+
+    /**
+     * M73: Report the progress of the SD print
+     *
+     * Without parameters the answer is M73 P<percent done> R<minutes left>.
+     * R comes from the print time estimate of the file, it is left out
+     * until the file has been scanned.
+     *
+     * The M73 P<percent> R<minutes> lines slicers put in the file are
+     * taken silently, the estimate of the file is used instead.
+     */
+    inline void gcode_M73(void) {
+      if (parser.seen('P') || parser.seen('R')) return;
+      SERIAL_MV("M73 P", (int)card.percentDone());
+      const int32_t left = card.isFileOpen() ? gcodeinfo.time_left(card.sdpos) : -1;
+      if (left >= 0) SERIAL_MV(" R", (int)((left + 59) / 60));
+      SERIAL_EOL();
+    }
+
+  #endif
+
   /**
    * M28: Start SD Write
    */
@@ -123,9 +154,53 @@
 
   /**
    * M29: Stop SD Write
-   * Processed in write to file routine above
+   * Processed in write to file routine above, here it ends M928
    */
-  inline void gcode_M29(void) { card.saving = false; }
+  inline void gcode_M29(void) {
+    card.saving = false;
+    #if HAS_SD_WRITE_BUFFER
+      card.stopLog();
+    #endif
+  }
+
+  #if HAS_SD_WRITE_BUFFER
+
+    #define CODE_M928
+
+    /**
+     * M928: Start SD logging (M928 filename.g) - ended by M29
+     *
+     * The commands run are written to the file through the
+     * write buffer, M28 or releasing the card end it too.
+     */
+    inline void gcode_M928(void) { card.startLog(parser.string_arg); }
+
+  #endif
+
+  #if ENABLED(SD_BINARY_UPLOAD)
+
+    #define CODE_M577
+
+    /**
+     * M577: Binary upload to SD
+     *
+     *  S<bytes> <filename>
+     *
+     * The file is allocated for its size, then the host sends it in
+     * 512 byte chunks with sequence and crc, see CardReader::startUpload.
+     */
+    inline void gcode_M577(void) {
+      char *name = parser.string_arg;
+      if (!name || *name != 'S') {
+        SERIAL_LM(ER, "M577 S<bytes> <filename>");
+        return;
+      }
+      const uint32_t size = parser.parse_long(name + 1, &name);
+      while (*name == ' ') name++;
+      card.startUpload(name, size);
+    }
+
+  #endif
 
   /**
    * M30 <filename>: Delete SD Card file
@@ -184,4 +259,90 @@
     }
   }
 
+  #if HAS_SD_GCODE_INFO
+
+    /**
+     * M36: Return file information
+     *
+     *  M36 <filename>
+     *
+     * {"err":0,"size":N,"height":N,"firstLayerHeight":N,"layerHeight":N,
+     *  "filament":[N],"generatedBy":"S","lines":N,"layers":N}
+     *
+     * lines and layers are left out until the file has been scanned.
+     */
+    inline void gcode_M36(void) {
+      gcodeinfo.report(card.curDir, parser.string_arg);
+    }
+
+    /**
+     * M415: Print the selected file from a layer
+     *
+     *  L<layer>   From the start of this layer, counted from 0, or the
+     *             nearest one before it in the layer table
+     *  Z<height>  From the layer at this height, or the nearest one below
+     *             it in the layer table
+     *
+     * The file goes on with E, tool and G90/G91, M82/M83 as they were
+     * at that layer. Z is raised to the layer before the first move.
+     * Heat and home first. Without L or Z the layer table is listed.
+     */
+    inline void gcode_M415(void) {
+      if (!card.cardOK || !card.isFileOpen() || card.sdprinting || !gcodeinfo.load(card.gcode_file)) {
+        SERIAL_LM(ER, "No file selected");
+        return;
+      }
+
+      int16_t index;
+      if (parser.seenval('L'))
+        index = gcodeinfo.find_layer(parser.value_ushort());
+      else if (parser.seenval('Z'))
+        index = gcodeinfo.find_z(parser.value_linear_units());
+      else {
+        gcodeinfo.report_layers();
+        return;
+      }
+
+      if (index < 0) {
+        SERIAL_LM(ER, "Layer not scanned yet");
+        return;
+      }
+      if (mechanics.axis_unhomed_error()) return;
+
+      gcodeinfo.print_from(index);
+      #if HAS_POWER_CONSUMPTION_SENSOR
+        powerManager.startpower = powerManager.consumption_hour;
+      #endif
+    }
+
+  #endif
+
+  #if HAS_POWER_LOSS_JOURNAL
+
+    #define CODE_M413
+    #define CODE_M414
+
+    /**
+     * M413: Report the newest record of the power-loss journal
+     */
+    inline void gcode_M413(void) { journal.report(); }
+
+    /**
+     * M414: Resume the print of the newest journal record
+     *
+     * Queues the commands that heat, home X and Y, restore tool,
+     * leveling, fans and position, then M414 C goes on with the file
+     * from the line that fed the oldest move still planned.
+     *
+     *  C  Continue the file from the record (the last resume step)
+     */
+    inline void gcode_M414(void) {
+      if (parser.seen('C'))
+        journal.resume_continue();
+      else
+        journal.resume();
+    }
+
+  #endif
+
 #endif // HAS_SDSUPPORT
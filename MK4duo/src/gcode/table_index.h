@@ -0,0 +1,64 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * table_index.h
+ *
+ * Direct index of the G and M code tables, built by the compiler from the
+ * tables themselves. Entry n is the position of code n in the table plus
+ * one, 0 if the code is not available, so enabling a CODE_Mxxx is enough.
+ */
+
+namespace code_index {
+
+  // 0 ... N-1 as a parameter pack, built with log(N) template depth
+  template<unsigned... I> struct seq { typedef seq type; };
+  template<class A, class B> struct cat;
+  template<unsigned... A, unsigned... B> struct cat<seq<A...>, seq<B...> > : seq<A..., (sizeof...(A) + B)...> {};
+  template<unsigned N> struct make_seq : cat<typename make_seq<N / 2>::type, typename make_seq<N - N / 2>::type> {};
+  template<> struct make_seq<0> : seq<> {};
+  template<> struct make_seq<1> : seq<0> {};
+
+  // Position of a code in a sorted table plus one, 0 if missing
+  template<typename T>
+  constexpr uint8_t find(const T * const table, const unsigned code, const int lo, const int hi) {
+    return lo > hi ? 0
+         : table[(lo + hi) / 2].code == code ? (lo + hi) / 2 + 1
+         : table[(lo + hi) / 2].code < code  ? find(table, code, (lo + hi) / 2 + 1, hi)
+         : find(table, code, lo, (lo + hi) / 2 - 1);
+  }
+
+  template<class S> struct G;
+  template<unsigned... I> struct G<seq<I...> > { static const uint8_t index[sizeof...(I)]; };
+  template<unsigned... I> const uint8_t G<seq<I...> >::index[sizeof...(I)] PROGMEM = { find(GCode_Table, I, 0, COUNT(GCode_Table) - 1)... };
+
+  template<class S> struct M;
+  template<unsigned... I> struct M<seq<I...> > { static const uint8_t index[sizeof...(I)]; };
+  template<unsigned... I> const uint8_t M<seq<I...> >::index[sizeof...(I)] PROGMEM = { find(MCode_Table, I, 0, COUNT(MCode_Table) - 1)... };
+
+}
+
+static_assert(COUNT(GCode_Table) < 255 && COUNT(MCode_Table) < 255, "Too many codes for a byte index.");
+
+// One byte per code, up to the highest code of each table
+typedef code_index::G<code_index::make_seq<GCode_Table[COUNT(GCode_Table) - 1].code + 1>::type> GCode_Index;
+typedef code_index::M<code_index::make_seq<MCode_Table[COUNT(MCode_Table) - 1].code + 1>::type> MCode_Index;
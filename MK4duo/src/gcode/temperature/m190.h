@@ -43,6 +43,10 @@
       heaters[BED_INDEX].target_temperature = parser.value_celsius();
 
     thermalManager.wait_heater(BED_INDEX, no_wait_for_cooling);
+
+    #if ENABLED(MESH_TEMPERATURE_BANK)
+      bedlevel.mesh_bank_select();
+    #endif
   }
 
 #endif // HAS_TEMP_BED
@@ -3713,7 +3713,7 @@ void kill_screen(const char* lcd_msg) {
       for (uint16_t i = 0; i < fileCnt; i++) {
         if (_menuLineNr == _thisItemNr) {
           card.getfilename(
-            #if ENABLED(SDCARD_RATHERRECENTFIRST)
+            #if ENABLED(SDCARD_RATHERRECENTFIRST) && DISABLED(SD_DIR_INDEX_SORT)
               fileCnt-1 -
             #endif
             i
@@ -46,6 +46,7 @@
       m_zwobble_consistent = false;
       zwobble_lastZ = -1.0;
       zwobble_lastZRod = -1.0;
+      zwobble_lutIndex = 1;
       m_zwobble_scalingFactor = 1.0;
       m_zwobble_sinusoidal = true;
       set_zwobble_amplitude(wobble[0]);
@@ -1141,6 +1142,7 @@
     void Cartesian_Mechanics::calculateLut() {
       zwobble_lastZ = -1.0;
       zwobble_lastZRod = -1.0; // reinitialize memorized Z values since we are changing the model
+      zwobble_lutIndex = 1;
       if (!areParametersConsistent()) return;
       if (!m_zwobble_sinusoidal) {
         initLinearLut();
@@ -1216,17 +1218,18 @@
     }
 
     float Cartesian_Mechanics::findInLut(float z) {
-      int i = 0;
       if (z >= ZACTUAL(zwobble_lutSize - 1))
         return ZROD(zwobble_lutSize - 1);
 
       if (z <= ZACTUAL(0))
         return ZROD(0);
 
-      for (i = 0; i < zwobble_lutSize; i++) {
-        if (ZACTUAL(i) > z)
-          break;
-      }
+      // Consecutive segments land in or next to the last bracket,
+      // so walk from there instead of scanning the whole LUT
+      int i = constrain(zwobble_lutIndex, 1, zwobble_lutSize - 1);
+      while (ZACTUAL(i - 1) > z) i--;
+      while (ZACTUAL(i) <= z) i++;
+      zwobble_lutIndex = i;
 
       float invZDist = 1 / (ZACTUAL(i) - ZACTUAL(i-1)); // distance between Z steps
 
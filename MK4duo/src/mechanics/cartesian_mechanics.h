@@ -72,7 +72,8 @@
                 m_zwobble_scalingFactor;
         bool    m_zwobble_consistent,
                 m_zwobble_sinusoidal;
-        int     zwobble_lutSize;
+        int     zwobble_lutSize,
+                zwobble_lutIndex;   // Upper bracket of the last LUT lookup
       #endif
 
     public: /** Public Function */
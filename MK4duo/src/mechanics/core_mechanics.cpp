@@ -35,6 +35,19 @@
 
   void Core_Mechanics::Init() { }
 
+  /**
+   * The steppers count A = a + f * b and B = CORESIGN(a - f * b),
+   * f being CORE_FACTOR, so a = (A + CORESIGN(B)) / 2 and
+   * b = (A - CORESIGN(B)) / (2 * f)
+   */
+  void Core_Mechanics::get_cartesian_from_steps(const long steps[XYZ]) {
+    const float m1 = steps[CORE_AXIS_1],
+                m2 = CORESIGN(steps[CORE_AXIS_2]);
+    LOOP_XYZ(i) cartesian_position[i] = steps[i] * steps_to_mm[i];
+    cartesian_position[CORE_AXIS_1] = 0.5 * (m1 + m2) * steps_to_mm[CORE_AXIS_1];
+    cartesian_position[CORE_AXIS_2] = 0.5 * (m1 - m2) / (CORE_FACTOR) * steps_to_mm[CORE_AXIS_2];
+  }
+
   /**
    * Home Core
    */
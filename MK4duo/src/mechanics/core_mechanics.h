@@ -62,6 +62,12 @@
        */
       void Init();
 
+      /**
+       * Get the cartesian_position[] array from stepper counts.
+       * The Core motors are turned back into the axes they move.
+       */
+      void get_cartesian_from_steps(const long steps[XYZ]) override;
+
       /**
        * Home all axes according to settings
        *
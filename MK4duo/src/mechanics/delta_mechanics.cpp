@@ -83,7 +83,7 @@
   }
 
   /**
-   * Get the stepper positions in the cartesian_position[] array.
+   * Get the cartesian_position[] array from stepper counts.
    * Forward kinematics are applied for DELTA.
    *
    * The result is in the current coordinate space with
@@ -91,11 +91,11 @@
    * unapply_leveling to obtain the "ideal" coordinates
    * suitable for current_position, etc.
    */
-  void Delta_Mechanics::get_cartesian_from_steppers() {
+  void Delta_Mechanics::get_cartesian_from_steps(const long steps[XYZ]) {
     InverseTransform(
-      get_axis_position_mm(A_AXIS),
-      get_axis_position_mm(B_AXIS),
-      get_axis_position_mm(C_AXIS),
+      steps[A_AXIS] * steps_to_mm[A_AXIS],
+      steps[B_AXIS] * steps_to_mm[B_AXIS],
+      steps[C_AXIS] * steps_to_mm[C_AXIS],
       cartesian_position
     );
     cartesian_position[X_AXIS] += LOGICAL_X_POSITION(0);
@@ -86,7 +86,7 @@
       void set_position_mm(const float position[NUM_AXIS]) override;
 
       /**
-       * Get the stepper positions in the cartesian_position[] array.
+       * Get the cartesian_position[] array from stepper counts.
        * Forward kinematics are applied for DELTA.
        *
        * The result is in the current coordinate space with
@@ -94,7 +94,7 @@
        * unapply_leveling to obtain the "ideal" coordinates
        * suitable for current_position, etc.
        */
-      void get_cartesian_from_steppers() override;
+      void get_cartesian_from_steps(const long steps[XYZ]) override;
 
       #if DISABLED(AUTO_BED_LEVELING_UBL)
         /**
@@ -102,9 +102,12 @@ void Mechanics::set_position_mm(const float position[NUM_AXIS]) {
  * suitable for current_position, etc.
  */
 void Mechanics::get_cartesian_from_steppers() {
-  cartesian_position[X_AXIS] = get_axis_position_mm(X_AXIS);
-  cartesian_position[Y_AXIS] = get_axis_position_mm(Y_AXIS);
-  cartesian_position[Z_AXIS] = get_axis_position_mm(Z_AXIS);
+  const long steps[XYZ] = { stepper.position(X_AXIS), stepper.position(Y_AXIS), stepper.position(Z_AXIS) };
+  get_cartesian_from_steps(steps);
+}
+
+void Mechanics::get_cartesian_from_steps(const long steps[XYZ]) {
+  LOOP_XYZ(i) cartesian_position[i] = steps[i] * steps_to_mm[i];
 }
 
 /**
@@ -377,6 +380,30 @@ void Mechanics::report_current_position() {
   SERIAL_MV(" Z:", current_position[Z_AXIS], 3);
   SERIAL_EMV(" E:", current_position[E_AXIS], 4);
 }
+
+void Mechanics::report_realtime_position() {
+  stepper_snapshot_t snap;
+  stepper.snapshot(snap);
+
+  get_cartesian_from_steps(snap.position);
+  #if PLANNER_LEVELING
+    bedlevel.unapply_leveling(cartesian_position);
+  #endif
+
+  SERIAL_MV( "X:", cartesian_position[X_AXIS], 2);
+  SERIAL_MV(" Y:", cartesian_position[Y_AXIS], 2);
+  SERIAL_MV(" Z:", cartesian_position[Z_AXIS], 3);
+  SERIAL_MV(" E:", snap.position[E_AXIS] * steps_to_mm[E_INDEX], 4);
+  SERIAL_MV(" Block:", (int)snap.block);
+  SERIAL_MV(" Queued:", (int)planner.movesplanned());
+  if (snap.moving) {
+    SERIAL_MV(" Steps:", snap.step_events_completed);
+    SERIAL_EMV("/", snap.step_event_count);
+  }
+  else
+    SERIAL_EM(" Idle");
+}
+
 void Mechanics::report_current_position_detail() {
 
   stepper.synchronize();
@@ -57,7 +57,9 @@
 
 #define RAW_CURRENT_POSITION(A)     RAW_##A##_POSITION(mechanics.current_position[A##_AXIS])
 
-#if PLANNER_LEVELING || ENABLED(ZWOBBLE) || ENABLED(HYSTERESIS)
+#define HAS_CORRECTION_PIPELINE (PLANNER_LEVELING || ENABLED(ZWOBBLE) || ENABLED(HYSTERESIS))
+
+#if HAS_CORRECTION_PIPELINE
   #define ARG_X float lx
   #define ARG_Y float ly
   #define ARG_Z float lz
@@ -216,7 +218,13 @@ class Mechanics {
      * unapply_leveling to obtain the "ideal" coordinates
      * suitable for current_position, etc.
      */
-    virtual void get_cartesian_from_steppers();
+    void get_cartesian_from_steppers();
+
+    /**
+     * Same as above for a set of stepper counts,
+     * like the ones taken by stepper.snapshot()
+     */
+    virtual void get_cartesian_from_steps(const long steps[XYZ]);
 
     /**
      * Set the current_position for an axis based on
@@ -309,6 +317,12 @@ class Mechanics {
     virtual void report_current_position();
     virtual void report_current_position_detail();
 
+    /**
+     * Report where the steppers are at this moment, and how far
+     * the planner has got, without waiting for the moves to end
+     */
+    void report_realtime_position();
+
     FORCE_INLINE void report_xyz(const float pos[XYZ]) { report_xyze(pos, 3); }
 
     //float get_homing_bump_feedrate(const AxisEnum axis);
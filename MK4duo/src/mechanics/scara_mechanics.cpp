@@ -108,19 +108,19 @@
   }
 
   /**
-   * Get the stepper positions in the cartes[] array.
-   * Forward kinematics are applied for DELTA and SCARA.
+   * Get the cartesian_position[] array from stepper counts.
+   * Forward kinematics are applied for SCARA, A and B are in degrees.
    *
    * The result is in the current coordinate space with
    * leveling applied. The coordinates need to be run through
    * unapply_leveling to obtain the "ideal" coordinates
    * suitable for current_position, etc.
    */
-  void Scara_Mechanics::get_cartesian_from_steppers() {
-    forward_kinematics_SCARA( stepper.get_axis_position_degrees(A_AXIS), stepper.get_axis_position_degrees(B_AXIS) );
+  void Scara_Mechanics::get_cartesian_from_steps(const long steps[XYZ]) {
+    forward_kinematics_SCARA(steps[A_AXIS] * steps_to_mm[A_AXIS], steps[B_AXIS] * steps_to_mm[B_AXIS]);
     cartesian_position[X_AXIS] += LOGICAL_X_POSITION(0);
     cartesian_position[Y_AXIS] += LOGICAL_Y_POSITION(0);
-    cartesian_position[Z_AXIS] = stepper.get_axis_position_mm(Z_AXIS);
+    cartesian_position[Z_AXIS] = steps[Z_AXIS] * steps_to_mm[Z_AXIS];
   }
 
    /**
@@ -60,7 +60,7 @@
       void report_current_position() override;
       void report_current_position_detail() override;
       
-      void get_cartesian_from_steppers() override;
+      void get_cartesian_from_steps(const long steps[XYZ]) override;
 
       /**
        * Prepare a linear move in a SCARA setup.
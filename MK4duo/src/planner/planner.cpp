@@ -114,6 +114,7 @@ void Planner::init() {
   previous_nominal_speed = 0.0;
   #if ABL_PLANAR
     bedlevel.matrix.set_to_identity();
+    bedlevel.refresh_correction();
   #endif
 }
 
@@ -589,6 +590,10 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
 
   block->active_extruder = extruder;
 
+  #if HAS_POWER_LOSS_JOURNAL
+    journal.plan(block);
+  #endif
+
   #if HAS_MKMULTI_TOOLS
     block->active_driver = tools.active_driver;
   #else
@@ -1292,6 +1297,38 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
 
 } // _buffer_line()
 
+#if HAS_CORRECTION_PIPELINE
+
+  /**
+   * Run the ordered correction pipeline on a logical target:
+   *  - Leveling: the compiled affine transform (ABL planar) or the
+   *    mesh offset with the cached cell, faded above z_fade_height
+   *  - Z-Wobble: rod/actual LUT lookup from the last bracket
+   *  - Hysteresis: shifts planner.position on direction changes
+   *
+   * Leveling state is rebuilt by Bedlevel::refresh_correction()
+   * when a parameter changes, so each segment costs one call here.
+   */
+  void Planner::apply_corrections(float &lx, float &ly, float &lz, const float &e
+    #if PLANNER_LEVELING
+      , const bool level/*=true*/
+    #endif
+  ) {
+    #if PLANNER_LEVELING
+      if (level) bedlevel.apply_leveling(lx, ly, lz);
+    #endif
+    #if ENABLED(ZWOBBLE)
+      mechanics.insert_zwobble_correction(lz);
+    #endif
+    #if ENABLED(HYSTERESIS)
+      mechanics.insert_hysteresis_correction(lx, ly, lz, e);
+    #else
+      UNUSED(e);
+    #endif
+  }
+
+#endif // HAS_CORRECTION_PIPELINE
+
 /**
  * Add a new linear movement to the buffer.
  * The target is NOT translated to delta/scara
@@ -1305,16 +1342,12 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
  *  extruder    - target extruder
  */
 void Planner::buffer_line(ARG_X, ARG_Y, ARG_Z, const float &e, const float &fr_mm_s, const uint8_t extruder) {
-  #if PLANNER_LEVELING && (IS_CARTESIAN || IS_CORE)
-    bedlevel.apply_leveling(lx, ly, lz);
-  #endif
-  #if ENABLED(ZWOBBLE)
-    // Calculate ZWobble
-    mechanics.insert_zwobble_correction(lz);
-  #endif
-  #if ENABLED(HYSTERESIS)
-    // Calculate Hysteresis
-    mechanics.insert_hysteresis_correction(lx, ly, lz, e);
+  #if HAS_CORRECTION_PIPELINE
+    apply_corrections(lx, ly, lz, e
+      #if PLANNER_LEVELING
+        , IS_CARTESIAN || IS_CORE
+      #endif
+    );
   #endif
   _buffer_line(lx, ly, lz, e, fr_mm_s, extruder);
 }
@@ -1329,19 +1362,9 @@ void Planner::buffer_line(ARG_X, ARG_Y, ARG_Z, const float &e, const float &fr_m
  *  extruder  - target extruder
  */
 void Planner::buffer_line_kinematic(const float ltarget[XYZE], const float &fr_mm_s, const uint8_t extruder) {
-  #if PLANNER_LEVELING || ENABLED(ZWOBBLE) || ENABLED(HYSTERESIS)
-    float lpos[XYZ]={ ltarget[X_AXIS], ltarget[Y_AXIS], ltarget[Z_AXIS] };
-    #if PLANNER_LEVELING
-      bedlevel.apply_leveling(lpos);
-    #endif
-    #if ENABLED(ZWOBBLE)
-      // Calculate ZWobble
-      mechanics.insert_zwobble_correction(lpos[Z_AXIS]);
-    #endif
-    #if ENABLED(HYSTERESIS)
-      // Calculate Hysteresis
-      mechanics.insert_hysteresis_correction(lpos[X_AXIS], lpos[Y_AXIS], lpos[Z_AXIS], ltarget[E_AXIS]);
-    #endif
+  #if HAS_CORRECTION_PIPELINE
+    float lpos[XYZ] = { ltarget[X_AXIS], ltarget[Y_AXIS], ltarget[Z_AXIS] };
+    apply_corrections(lpos[X_AXIS], lpos[Y_AXIS], lpos[Z_AXIS], ltarget[E_AXIS]);
   #else
     const float * const lpos = ltarget;
   #endif
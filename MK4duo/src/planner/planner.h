@@ -114,6 +114,11 @@ typedef struct {
 
   uint32_t segment_time;
 
+  #if HAS_POWER_LOSS_JOURNAL
+    uint32_t sdpos;                             // SD file position of the line that planned the block
+    float sd_position[XYZE];                    // Logical position before that line
+  #endif
+
   #if ENABLED(LASER)
     uint8_t laser_mode;         // CONTINUOUS, PULSED, RASTER
     bool laser_status;          // LASER_OFF, LASER_ON
@@ -326,6 +331,18 @@ class Planner {
 
   private: /** Private Function */
 
+    #if HAS_CORRECTION_PIPELINE
+      /**
+       * Apply leveling, Z-Wobble and hysteresis in order
+       * to a logical target, ahead of the kinematics.
+       */
+      static void apply_corrections(float &lx, float &ly, float &lz, const float &e
+        #if PLANNER_LEVELING
+          , const bool level=true
+        #endif
+      );
+    #endif
+
     /**
      * Get the index of the next / previous block in the ring buffer
      */
@@ -182,9 +182,6 @@ void Printer::setup() {
   SERIAL_SMV(ECHO, MSG_FREE_MEMORY, HAL::getFreeRam());
   SERIAL_EMV(MSG_PLANNER_BUFFER_BYTES, (int)sizeof(block_t)*BLOCK_BUFFER_SIZE);
 
-  // Send "ok" after commands by default
-  commands.reset_send_ok();
-
   #if MECH(MUVE3D) && ENABLED(PROJECTOR_PORT) && ENABLED(PROJECTOR_BAUDRATE)
     DLPSerial.begin(PROJECTOR_BAUDRATE);
   #endif
@@ -590,6 +587,26 @@ void Printer::idle(bool no_stepper_sleep/*=false*/) {
 
   handle_Interrupt_Event();
 
+  #if ENABLED(FASTER_GCODE_PARSER)
+    commands.decode_pending();
+  #endif
+
+  #if HAS_SD_READ_AHEAD
+    card.prefetch();
+  #endif
+
+  #if HAS_SD_GCODE_INFO
+    gcodeinfo.idle();
+  #endif
+
+  #if HAS_SD_WRITE_BUFFER
+    card.writeIdle();
+  #endif
+
+  #if HAS_POWER_LOSS_JOURNAL
+    journal.idle();
+  #endif
+
   print_job_counter.tick();
 
   if (HAL::execute_100ms) {
@@ -1037,7 +1054,7 @@ void Printer::calculate_volumetric_multipliers() {
   void Printer::host_keepalive() {
     const millis_t now = millis();
     if (host_keepalive_interval && busy_state != NOT_BUSY) {
-      if (PENDING(now, next_busy_signal_ms)) return;
+      if (PENDING(now, next_busy_signal_ms) || serial_skip_optional()) return;
       switch (busy_state) {
         case IN_HANDLER:
         case IN_PROCESS:
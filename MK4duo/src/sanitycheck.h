@@ -40,6 +40,15 @@
 #if DISABLED(BAUDRATE)
   #error DEPENDENCY ERROR: Missing setting BAUDRATE
 #endif
+#if ENABLED(SERIAL_PORT_2)
+  #if SERIAL_PORT_2 == SERIAL_PORT
+    #error DEPENDENCY ERROR: SERIAL_PORT_2 must be different from SERIAL_PORT
+  #elif ENABLED(BLUETOOTH) && SERIAL_PORT_2 == BLUETOOTH_PORT
+    #error DEPENDENCY ERROR: SERIAL_PORT_2 must be different from BLUETOOTH_PORT
+  #elif ENABLED(__AVR__) && SERIAL_PORT_2 == -1
+    #error DEPENDENCY ERROR: SERIAL_PORT_2 -1 (SerialUSB) is only for DUE
+  #endif
+#endif
 #if DISABLED(STRING_CONFIG_H_AUTHOR)
   #define STRING_CONFIG_H_AUTHOR "(none, default config)"
 #endif
@@ -693,6 +702,34 @@ static_assert(1 >= 0
   #error "ENABLE_LEVELING_FADE_HEIGHT requires Bed Level"
 #endif
 
+/**
+ * PROBE_BED_TEMP_BAND requirements
+ */
+#if ENABLED(PROBE_BED_TEMP_BAND)
+  #if ENABLED(PROBING_HEATERS_OFF)
+    #error "PROBE_BED_TEMP_BAND is not compatible with PROBING_HEATERS_OFF."
+  #elif !HAS_TEMP_BED
+    #error "PROBE_BED_TEMP_BAND requires a heated bed."
+  #elif !HAS_AUTOLEVEL || !(ABL_GRID || ENABLED(AUTO_BED_LEVELING_UBL))
+    #error "PROBE_BED_TEMP_BAND requires AUTO_BED_LEVELING_UBL, LINEAR or BILINEAR with a probe."
+  #endif
+#endif
+
+/**
+ * MESH_TEMPERATURE_BANK requirements
+ */
+#if ENABLED(MESH_TEMPERATURE_BANK)
+  #if DISABLED(AUTO_BED_LEVELING_UBL) && DISABLED(AUTO_BED_LEVELING_BILINEAR)
+    #error "MESH_TEMPERATURE_BANK requires AUTO_BED_LEVELING_UBL or AUTO_BED_LEVELING_BILINEAR."
+  #elif DISABLED(EEPROM_SETTINGS) || HAS_EEPROM_SD
+    #error "MESH_TEMPERATURE_BANK requires EEPROM_SETTINGS on a real EEPROM (not EEPROM_SD)."
+  #elif !HAS_TEMP_BED
+    #error "MESH_TEMPERATURE_BANK requires a heated bed."
+  #elif MESH_BANK_SLOTS < 2 || MESH_BANK_SLOTS > 16
+    #error "MESH_BANK_SLOTS must be between 2 and 16."
+  #endif
+#endif
+
 /**
  * LCD_BED_LEVELING requirements
  */
@@ -872,6 +909,39 @@ static_assert(1 >= 0
   #if ENABLED(SD_SETTINGS) && DISABLED(SD_CFG_SECONDS)
     #error DEPENDENCY ERROR: Missing setting SD_CFG_SECONDS
   #endif
+  #if ENABLED(SD_READ_AHEAD) && DISABLED(SD_READ_AHEAD_BLOCKS)
+    #error DEPENDENCY ERROR: Missing setting SD_READ_AHEAD_BLOCKS
+  #endif
+  #if ENABLED(SD_READ_AHEAD) && DISABLED(SD_READ_AHEAD_IDLE_BLOCKS)
+    #error DEPENDENCY ERROR: Missing setting SD_READ_AHEAD_IDLE_BLOCKS
+  #endif
+  #if ENABLED(SD_WRITE_BUFFER) && DISABLED(SD_WRITE_BUFFER_BLOCKS)
+    #error DEPENDENCY ERROR: Missing setting SD_WRITE_BUFFER_BLOCKS
+  #endif
+  #if ENABLED(SD_WRITE_BUFFER) && DISABLED(SD_WRITE_BUFFER_FLUSH)
+    #error DEPENDENCY ERROR: Missing setting SD_WRITE_BUFFER_FLUSH
+  #endif
+  #if ENABLED(SD_DIR_INDEX) && DISABLED(SD_DIR_INDEX_SIZE)
+    #error DEPENDENCY ERROR: Missing setting SD_DIR_INDEX_SIZE
+  #endif
+  #if ENABLED(SD_DIR_INDEX_SORT) && DISABLED(SD_DIR_INDEX_KEY)
+    #error DEPENDENCY ERROR: Missing setting SD_DIR_INDEX_KEY
+  #endif
+  #if ENABLED(SD_GCODE_INFO) && DISABLED(SD_GCODE_INFO_LAYERS)
+    #error DEPENDENCY ERROR: Missing setting SD_GCODE_INFO_LAYERS
+  #endif
+  #if ENABLED(SD_PRINT_TIME) && DISABLED(SD_PRINT_TIME_BLOCKS)
+    #error DEPENDENCY ERROR: Missing setting SD_PRINT_TIME_BLOCKS
+  #endif
+  #if ENABLED(POWER_LOSS_JOURNAL) && DISABLED(POWER_LOSS_JOURNAL_RECORDS)
+    #error DEPENDENCY ERROR: Missing setting POWER_LOSS_JOURNAL_RECORDS
+  #endif
+  #if ENABLED(POWER_LOSS_JOURNAL) && DISABLED(POWER_LOSS_JOURNAL_TIME)
+    #error DEPENDENCY ERROR: Missing setting POWER_LOSS_JOURNAL_TIME
+  #endif
+  #if ENABLED(POWER_LOSS_JOURNAL) && DISABLED(POWER_LOSS_JOURNAL_PURGE)
+    #error DEPENDENCY ERROR: Missing setting POWER_LOSS_JOURNAL_PURGE
+  #endif
 #endif
 #if ENABLED(SHOW_BOOTSCREEN)
   #if DISABLED(STRING_SPLASH_LINE1)
@@ -1206,9 +1276,18 @@ static_assert(1 >= 0
 #if DISABLED(BUFSIZE)
   #error DEPENDENCY ERROR: Missing setting BUFSIZE
 #endif
+#if MAX_CMD_SIZE > 255
+  #error DEPENDENCY ERROR: MAX_CMD_SIZE must be 255 or less
+#endif
 #if ENABLED(SERIAL_XON_XOFF) && RX_BUFFER_SIZE < 1024
   #error DEPENDENCY ERROR: For SERIAL_XON_XOFF set RX_BUFFER_SIZE to 1024 or more
 #endif
+#if ENABLED(BINARY_GCODE_TRANSPORT) && DISABLED(FASTER_GCODE_PARSER)
+  #error DEPENDENCY ERROR: BINARY_GCODE_TRANSPORT requires FASTER_GCODE_PARSER
+#endif
+#if ENABLED(BINARY_GCODE_TRANSPORT) && MAX_CMD_SIZE > 254
+  #error DEPENDENCY ERROR: BINARY_GCODE_TRANSPORT requires MAX_CMD_SIZE of 254 or less
+#endif
 #if DISABLED(SDSUPPORT) && ENABLED(SERIAL_STATS_MAX_RX_QUEUED)
   #error DEPENDENCY ERROR: You must enabled SDSUPPORT for SERIAL_STATS_MAX_RX_QUEUED
 #endif
@@ -1693,6 +1772,57 @@ static_assert(1 >= 0
 #if ENABLED(SD_SETTINGS) && DISABLED(SDSUPPORT)
   #error DEPENDENCY ERROR: You have to enable SDSUPPORT to use SD_SETTINGS
 #endif
+#if ENABLED(SD_BINARY_UPLOAD) && DISABLED(SDSUPPORT)
+  #error DEPENDENCY ERROR: You have to enable SDSUPPORT to use SD_BINARY_UPLOAD
+#endif
+#if HAS_SD_READ_AHEAD && !WITHIN(SD_READ_AHEAD_BLOCKS, 2, 64)
+  #error CONFLICT ERROR: SD_READ_AHEAD_BLOCKS must be between 2 and 64
+#endif
+#if HAS_SD_READ_AHEAD && SD_READ_AHEAD_IDLE_BLOCKS < 1
+  #error CONFLICT ERROR: SD_READ_AHEAD_IDLE_BLOCKS must be at least 1
+#endif
+#if ENABLED(SD_WRITE_BUFFER) && DISABLED(SDSUPPORT)
+  #error DEPENDENCY ERROR: You have to enable SDSUPPORT to use SD_WRITE_BUFFER
+#endif
+#if HAS_SD_WRITE_BUFFER && !WITHIN(SD_WRITE_BUFFER_BLOCKS, 1, 16)
+  #error CONFLICT ERROR: SD_WRITE_BUFFER_BLOCKS must be between 1 and 16
+#endif
+#if HAS_SD_WRITE_BUFFER && SD_WRITE_BUFFER_FLUSH < 1
+  #error CONFLICT ERROR: SD_WRITE_BUFFER_FLUSH must be 1 or more seconds
+#endif
+#if ENABLED(SD_DIR_INDEX) && DISABLED(SDSUPPORT)
+  #error DEPENDENCY ERROR: You have to enable SDSUPPORT to use SD_DIR_INDEX
+#endif
+#if ENABLED(SD_DIR_INDEX_SORT) && DISABLED(SD_DIR_INDEX)
+  #error DEPENDENCY ERROR: You have to enable SD_DIR_INDEX to use SD_DIR_INDEX_SORT
+#endif
+#if HAS_SD_DIR_INDEX && !WITHIN(SD_DIR_INDEX_SIZE, 8, 1024)
+  #error CONFLICT ERROR: SD_DIR_INDEX_SIZE must be between 8 and 1024
+#endif
+#if HAS_SD_DIR_INDEX && ENABLED(SD_DIR_INDEX_SORT) && !WITHIN(SD_DIR_INDEX_KEY, 1, 16)
+  #error CONFLICT ERROR: SD_DIR_INDEX_KEY must be between 1 and 16
+#endif
+#if ENABLED(SD_GCODE_INFO) && DISABLED(SDSUPPORT)
+  #error DEPENDENCY ERROR: You have to enable SDSUPPORT to use SD_GCODE_INFO
+#endif
+#if HAS_SD_GCODE_INFO && (!WITHIN(SD_GCODE_INFO_LAYERS, 4, 1024) || (SD_GCODE_INFO_LAYERS & 1))
+  #error CONFLICT ERROR: SD_GCODE_INFO_LAYERS must be even and between 4 and 1024
+#endif
+#if ENABLED(SD_PRINT_TIME) && DISABLED(SD_GCODE_INFO)
+  #error DEPENDENCY ERROR: You have to enable SD_GCODE_INFO to use SD_PRINT_TIME
+#endif
+#if HAS_SD_PRINT_TIME && !WITHIN(SD_PRINT_TIME_BLOCKS, 2, BLOCK_BUFFER_SIZE)
+  #error CONFLICT ERROR: SD_PRINT_TIME_BLOCKS must be between 2 and BLOCK_BUFFER_SIZE
+#endif
+#if ENABLED(POWER_LOSS_JOURNAL) && DISABLED(SDSUPPORT)
+  #error DEPENDENCY ERROR: You have to enable SDSUPPORT to use POWER_LOSS_JOURNAL
+#endif
+#if HAS_POWER_LOSS_JOURNAL && !WITHIN(POWER_LOSS_JOURNAL_RECORDS, 2, 64)
+  #error CONFLICT ERROR: POWER_LOSS_JOURNAL_RECORDS must be between 2 and 64
+#endif
+#if HAS_POWER_LOSS_JOURNAL && POWER_LOSS_JOURNAL_TIME < 1
+  #error CONFLICT ERROR: POWER_LOSS_JOURNAL_TIME must be at least 1 second
+#endif
 
 /**
  * EEPROM test
@@ -363,6 +363,8 @@ bool SdBaseFile::addCluster() {
     DBG_FAIL_MACRO;
     goto FAIL;
   }
+  // the new cluster may be anywhere
+  flags_ &= ~F_FILE_CONTIGUOUS;
   // if first cluster of file link to directory entry
   if (firstCluster_ == 0) {
     firstCluster_ = curCluster_;
@@ -437,6 +439,21 @@ bool SdBaseFile::close() {
   return rtn;
 }
 //------------------------------------------------------------------------------
+/** Walk the FAT chain once to see if the file is contiguous.
+ *
+ * Once it is, read(), write() and seekSet() find clusters by
+ * counting from the first one and never read the FAT again.
+ *
+ * \return True if the file is contiguous.
+ */
+bool SdBaseFile::checkContiguous() {
+  uint32_t bgn, end;
+  flags_ &= ~F_FILE_CONTIGUOUS;
+  if (isFile() && contiguousRange(&bgn, &end))
+    flags_ |= F_FILE_CONTIGUOUS;
+  return isContiguous();
+}
+//------------------------------------------------------------------------------
 /** Check for contiguous file and return its raw block range.
  *
  * \param[out] bgnBlock the first block address for the file.
@@ -518,7 +535,7 @@ bool SdBaseFile::createContiguous(SdBaseFile* dirFile,
   fileSize_ = size;
 
   // insure sync() will update dir entry
-  flags_ |= F_FILE_DIR_DIRTY;
+  flags_ |= F_FILE_DIR_DIRTY | F_FILE_CONTIGUOUS;
 
   return sync();
 
@@ -682,6 +699,9 @@ uint8_t SdBaseFile::lsRecursive(SdBaseFile* parent, uint8_t level, char* findFil
     if (strcmp(card.tempLongFilename, "..") == 0) continue;
     if (card.tempLongFilename[0] == '.') continue; // MAC CRAP
     if (DIR_IS_SUBDIR(p)) {
+      #if HAS_SD_GCODE_INFO
+        if (!level && !strcmp_P(card.tempLongFilename, PSTR(GCODE_INFO_DIR))) continue; // Job info sidecars
+      #endif
       if (level >= SD_MAX_FOLDER_DEPTH) continue; // can't go deeper
       if (level < SD_MAX_FOLDER_DEPTH && findFilename == NULL) {
         if (level && !isJson) {
@@ -1312,6 +1332,44 @@ bool SdBaseFile::open(SdBaseFile* dirFile, uint16_t index, uint8_t oflag) {
   // open cached entry
   return openCachedEntry(index & 0xF, oflag);
 
+FAIL:
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Open a file by the place of its directory entry, dirBlock_ and
+ * dirIndex_ of a file opened before.
+ *
+ * \param[in] vol The volume the file is on.
+ * \param[in] dirBlock Block of the directory entry.
+ * \param[in] dirIndex Index of the entry in the block.
+ * \param[in] oflag Values for \a oflag are constructed by a bitwise-inclusive
+ * OR of open flags. see SdBaseFile::open(SdBaseFile*, const char*, uint8_t).
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdBaseFile::openEntry(SdVolume* vol, uint32_t dirBlock, uint8_t dirIndex, uint8_t oflag) {
+  dir_t* p;
+
+  // error if already open
+  if (isOpen() || !vol || dirIndex > 0xF) {
+    DBG_FAIL_MACRO;
+    goto FAIL;
+  }
+  vol_ = vol;
+  if (!vol_->cacheFetch(dirBlock, SdVolume::CACHE_FOR_READ)) {
+    DBG_FAIL_MACRO;
+    goto FAIL;
+  }
+  // error if empty slot or '.' or '..'
+  p = &vol_->cacheAddress()->dir[dirIndex];
+  if (p->name[0] == DIR_NAME_FREE ||
+      p->name[0] == DIR_NAME_DELETED || p->name[0] == '.') {
+    DBG_FAIL_MACRO;
+    goto FAIL;
+  }
+  return openCachedEntry(dirIndex, oflag);
+
 FAIL:
   return false;
 }
@@ -1822,6 +1880,9 @@ int SdBaseFile::read(void* buf, size_t nbyte) {
           // use first cluster in file
           curCluster_ = firstCluster_;
         }
+        else if (flags_ & F_FILE_CONTIGUOUS) {
+          curCluster_++;
+        }
         else {
           // get next cluster from FAT
           if (!vol_->fatGet(curCluster_, &curCluster_)) {
@@ -1893,6 +1954,44 @@ FAIL:
   return -1;
 }
 
+//------------------------------------------------------------------------------
+/** Bytes from the current position to the end of its block, read
+ * in place from the volume cache. skipBlock() consumes them and must
+ * take at least one before the next call, as entering a cluster here
+ * moves curCluster_ on.
+ *
+ * \param[out] src Set to the first byte.
+ *
+ * \return The number of bytes, 0 at end of file or -1 on error.
+ */
+int16_t SdBaseFile::peekBlock(const uint8_t* &src) {
+  if (!isOpen() || !(flags_ & O_READ)) return -1;
+  if (curPosition_ >= fileSize_) return 0;
+
+  const uint16_t offset = curPosition_ & 0x1FF;
+  const uint8_t blockOfCluster = vol_->blockOfCluster(curPosition_);
+  uint32_t block;
+  if (type_ == FAT_FILE_TYPE_ROOT_FIXED)
+    block = vol_->rootDirStart() + (curPosition_ >> 9);
+  else {
+    if (offset == 0 && blockOfCluster == 0) {
+      if (curPosition_ == 0)
+        curCluster_ = firstCluster_;
+      else if (flags_ & F_FILE_CONTIGUOUS)
+        curCluster_++;
+      else if (!vol_->fatGet(curCluster_, &curCluster_))
+        return -1;
+    }
+    block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
+  }
+
+  cache_t* pc = vol_->cacheFetch(block, SdVolume::CACHE_FOR_READ);
+  if (!pc) return -1;
+  src = pc->data + offset;
+  const uint32_t left = fileSize_ - curPosition_;
+  return left < 512 - offset ? left : 512 - offset;
+}
+
 /** 
  * Convert the dir_t name field of the file (which contains blank fills)
  * into a proper filename string without spaces inside.
@@ -2429,6 +2528,12 @@ bool SdBaseFile::seekSet(uint32_t pos) {
   nCur = (curPosition_ - 1) >> (vol_->clusterSizeShift_ + 9);
   nNew = (pos - 1) >> (vol_->clusterSizeShift_ + 9);
 
+  if (flags_ & F_FILE_CONTIGUOUS) {
+    curCluster_ = firstCluster_ + nNew;
+    curPosition_ = pos;
+    goto done;
+  }
+
   if (nNew < nCur || curPosition_ == 0) {
     // must follow chain from first cluster
     curCluster_ = firstCluster_;
@@ -2771,7 +2876,11 @@ int SdBaseFile::write(const void* buf, size_t nbyte) {
     uint16_t blockOffset = curPosition_ & 0x1FF;
     if (blockOfCluster == 0 && blockOffset == 0) {
       // start of new cluster
-      if (curCluster_ != 0) {
+      if (curCluster_ != 0 && (flags_ & F_FILE_CONTIGUOUS) && curPosition_ < fileSize_) {
+        // still inside the clusters of a contiguous file
+        curCluster_++;
+      }
+      else if (curCluster_ != 0) {
         uint32_t next;
         if (!vol_->fatGet(curCluster_, &next)) {
           DBG_FAIL_MACRO;
@@ -4226,6 +4335,196 @@ void SdFile::writeln_P(PGM_P str) {
   write_P(PSTR("\r\n"));
 }
 
+#if HAS_SD_READ_AHEAD
+// ================ SdReadAhead ===================
+
+//------------------------------------------------------------------------------
+/** Start reading a file from a position, nothing is read yet.
+ *
+ * \param[in] file Open file to read.
+ * \param[in] pos Position of the first byte.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdReadAhead::start(SdBaseFile* file, const uint32_t pos) {
+  SdVolume* vol = file->volume();
+  file_ = file;
+  size_ = file->fileSize();
+  head_ = count_ = 0;
+  end_ = 0;
+  pos_ = pos;
+  index_ = pos & 0x1FF;
+  fetchPos_ = pos & ~0x1FFUL;
+  if (fetchPos_ >= size_) return true;
+  cluster_ = file->firstCluster();
+  if (file->isContiguous()) {
+    cluster_ += fetchPos_ >> (9 + vol->clusterSizeShift());
+    nextCluster_ = cluster_ + 1;
+    return true;
+  }
+  // walk the chain to the cluster of pos and look up the one after it
+  for (uint32_t n = fetchPos_ >> (9 + vol->clusterSizeShift()); n--;) {
+    if (!vol->fatGet(cluster_, &cluster_)) goto FAIL;
+  }
+  if (!vol->fatGet(cluster_, &nextCluster_)) goto FAIL;
+  return true;
+
+FAIL:
+  DBG_FAIL_MACRO;
+  file_ = NULL;
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Read the free buffers in one multi-block read.
+ *
+ * The read stops at the end of a cluster unless the next cluster
+ * follows on the card. The FAT entry of the cluster entered is
+ * read after the data, to be ready at the next boundary.
+ *
+ * \param[in] most Most blocks to read.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdReadAhead::fill(const uint8_t most/*=SD_READ_AHEAD_BLOCKS*/) {
+  if (!file_) return false;
+  SdVolume* vol = file_->volume();
+  Sd2Card* sd = vol->sdCard();
+  uint8_t n = SD_READ_AHEAD_BLOCKS - count_;
+  if (n > most) n = most;
+  if (fetchPos_ >= size_ || !n) return true;
+  const uint32_t left = (size_ - fetchPos_ + 511) >> 9;
+  if (n > left) n = left;
+
+  uint8_t blockOfCluster = vol->blockOfCluster(fetchPos_);
+  const uint32_t block = vol->clusterStartBlock(cluster_) + blockOfCluster;
+  bool lookup = false, advance = false;
+
+  // a dirty cached block would be newer than the card
+  if (vol->cacheBlockNumber() >= block && vol->cacheBlockNumber() < block + n && !vol->cacheSync()) goto FAIL;
+  if (!sd->readStart(block)) goto FAIL;
+
+  while (n--) {
+    uint8_t tail = head_ + count_;
+    if (tail >= SD_READ_AHEAD_BLOCKS) tail -= SD_READ_AHEAD_BLOCKS;
+    if (!sd->readData(buf_[tail])) {
+      sd->readStop();
+      goto FAIL;
+    }
+    count_++;
+    fetchPos_ += 512;
+    if (++blockOfCluster == vol->blocksPerCluster()) {
+      blockOfCluster = 0;
+      // a contiguous file goes on in the next cluster
+      if (file_->isContiguous()) {
+        nextCluster_ = ++cluster_ + 1;
+        continue;
+      }
+      // the FAT can't be read inside the multi-block read
+      if (lookup) {
+        advance = true;
+        break;
+      }
+      lookup = true;
+      if (nextCluster_ != cluster_ + 1) n = 0;
+      cluster_ = nextCluster_;
+    }
+  }
+
+  if (!sd->readStop()) goto FAIL;
+  if (lookup && fetchPos_ < size_) {
+    if (advance && !vol->fatGet(cluster_, &cluster_)) goto FAIL;
+    if (!vol->fatGet(cluster_, &nextCluster_)) goto FAIL;
+  }
+  return true;
+
+FAIL:
+  DBG_FAIL_MACRO;
+  // drop what was read, the next fill starts again from the chain
+  start(file_, pos_);
+  return false;
+}
+//------------------------------------------------------------------------------
+// Move to the next buffer, filling it now if the idle time didn't
+bool SdReadAhead::load() {
+  if (!file_ || pos_ >= size_) return false;
+  if (end_) {
+    if (++head_ == SD_READ_AHEAD_BLOCKS) head_ = 0;
+    count_--;
+    index_ = end_ = 0;
+  }
+  if (!count_ && (!fill() || !count_)) return false;
+  const uint32_t left = size_ - (pos_ - index_);
+  end_ = left < 512 ? left : 512;
+  return true;
+}
+#endif  // HAS_SD_READ_AHEAD
+
+#if HAS_SD_WRITE_BUFFER
+// ================ SdWriteBuffer ===================
+
+//------------------------------------------------------------------------------
+/** Add bytes, the full blocks go to the file when the buffer is full.
+ *
+ * \param[in] buf Bytes to write.
+ * \param[in] nbyte Their count.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdWriteBuffer::write(const void* buf, size_t nbyte) {
+  if (!file_) return false;
+  const uint8_t* src = (const uint8_t*)buf;
+  while (nbyte) {
+    if (count_ == sizeof(buf_) && !flush(false)) return false;
+    uint16_t n = sizeof(buf_) - count_;
+    if (n > nbyte) n = nbyte;
+    memcpy(buf_ + count_, src, n);
+    count_ += n;
+    src += n;
+    nbyte -= n;
+  }
+  return true;
+}
+//------------------------------------------------------------------------------
+/** Write the buffer to the file.
+ *
+ * Without \a sync only the bytes up to the last block boundary of the
+ * file go, the rest waits for more. After the first flush the file is
+ * on a boundary and whole blocks go with one multi-block write.
+ *
+ * \param[in] sync Write all, then the last block and the directory entry.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdWriteBuffer::flush(const bool sync) {
+  if (!file_) return false;
+  const uint32_t pos = file_->curPosition(),
+                 end = (pos + count_) & ~0x1FFUL;
+  const uint16_t n = sync ? count_ : end > pos ? end - pos : 0;
+  if (n) {
+    if (file_->write(buf_, n) != (int)n) goto FAIL;
+    count_ -= n;
+    memmove(buf_, buf_ + n, count_);
+  }
+  if (sync && !file_->sync()) goto FAIL;
+  return true;
+
+FAIL:
+  DBG_FAIL_MACRO;
+  return false;
+}
+//------------------------------------------------------------------------------
+/** Write all and let the file go, it stays open.
+ *
+ * \return true for success or false for failure.
+ */
+bool SdWriteBuffer::stop() {
+  const bool ok = flush(true);
+  file_ = NULL;
+  count_ = 0;
+  return ok;
+}
+#endif  // HAS_SD_WRITE_BUFFER
+
 // ================ SdFatUtil.cpp ===================
 
 //------------------------------------------------------------------------------
@@ -1389,6 +1389,7 @@
    private:
     // Allow SdBaseFile access to SdVolume private data.
     friend class SdBaseFile;
+    friend class SdReadAhead;
   //------------------------------------------------------------------------------
     uint32_t allocSearchStart_;   // start cluster for alloc search
     uint8_t blocksPerCluster_;    // cluster size in blocks
@@ -1684,6 +1685,7 @@
     //----------------------------------------------------------------------------
     /** \return number of bytes available from yhe current position to EOF */
     uint32_t available() {return fileSize() - curPosition();}
+    bool checkContiguous();
     bool close();
     bool contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock);
     bool createContiguous(SdBaseFile* dirFile,
@@ -1739,6 +1741,9 @@
     uint8_t lfn_checksum(const unsigned char *pFCBName);
     bool openParentReturnFile(SdBaseFile* dirFile, const char* path, uint8_t *dname, SdBaseFile *newParent, bool bMakeDirs);
 
+    /** \return True if checkContiguous() or createContiguous() found the
+     * clusters of the file in one run on the card. */
+    bool isContiguous() const {return flags_ & F_FILE_CONTIGUOUS;}
     /** \return True if this is a directory else false. */
     bool isDir() const {return type_ >= FAT_FILE_TYPE_MIN_DIR;}
     /** \return True if this is a normal file else false. */
@@ -1761,6 +1766,7 @@
     bool open(SdBaseFile* dirFile, const char* path, uint8_t oflag);
     bool open(const char* path, uint8_t oflag = O_READ);
     bool openNext(SdBaseFile* dirFile, uint8_t oflag);
+    bool openEntry(SdVolume* vol, uint32_t dirBlock, uint8_t dirIndex, uint8_t oflag);
     bool openRoot(SdVolume* vol);
     int8_t readDir(dir_t& dir, char *longfilename) {return readDir(&dir, longfilename);}
     int peek();
@@ -1775,6 +1781,9 @@
     bool printName();
     int16_t read();
     int read(void* buf, size_t nbyte);
+    int16_t peekBlock(const uint8_t* &src);
+    /** Consume \a n bytes given by peekBlock(), at least one. */
+    void skipBlock(const uint16_t n) {curPosition_ += n;}
     int8_t readDir(dir_t* dir, char *longfilename);
 
     static bool remove(SdBaseFile* dirFile, const char* path);
@@ -1824,6 +1833,8 @@
     // bits defined in flags_
     // should be 0x0F
     static uint8_t const F_OFLAG = (O_ACCMODE | O_APPEND | O_SYNC);
+    // clusters follow each other on the card, no FAT walk to find them
+    static uint8_t const F_FILE_CONTIGUOUS = 0x40;
     // sync of directory entry required
     static uint8_t const F_FILE_DIR_DIRTY = 0x80;
 
@@ -2051,6 +2062,99 @@
     void write_P(PGM_P str);
     void writeln_P(PGM_P str);
   };
+
+  #if HAS_SD_READ_AHEAD
+    //------------------------------------------------------------------------------
+    /**
+     * \class SdReadAhead
+     * \brief Sequential reader that keeps a file some blocks ahead.
+     *
+     * fill() reads the free blocks with one multi-block read and
+     * looks up the next cluster as soon as a cluster is entered,
+     * so a cluster boundary never waits for the FAT. A contiguous
+     * file is read across clusters without the FAT at all.
+     */
+    class SdReadAhead {
+     public:
+      SdReadAhead() : file_(NULL) {}
+      bool start(SdBaseFile* file, const uint32_t pos);
+      void stop() {file_ = NULL;}
+      bool fill(const uint8_t most=SD_READ_AHEAD_BLOCKS);
+      /** Fill from idle time, once half the buffers are free so the
+       * multi-block read takes several, and at most
+       * SD_READ_AHEAD_IDLE_BLOCKS so the loop isn't held long.
+       * \return true for success or false for failure.
+       */
+      bool idleFill() {
+        return SD_READ_AHEAD_BLOCKS - count_ < SD_READ_AHEAD_BLOCKS / 2 || fill(SD_READ_AHEAD_IDLE_BLOCKS);
+      }
+      /** \return The next byte, -1 at end of file or on error. */
+      int16_t read() {
+        if (index_ < end_ || load()) {
+          pos_++;
+          return buf_[head_][index_++];
+        }
+        return -1;
+      }
+      /** Bytes from the read position to the end of their buffer.
+       * \param[out] src Set to the first of them.
+       * \return Their count, 0 at end of file or -1 on error.
+       */
+      int16_t peekBlock(const uint8_t* &src) {
+        if (index_ >= end_ && !load()) return pos_ < size_ ? -1 : 0;
+        src = buf_[head_] + index_;
+        return end_ - index_;
+      }
+      /** Consume \a n bytes given by peekBlock(). */
+      void skipBlock(const uint16_t n) {index_ += n; pos_ += n;}
+      /** \return True if the reader has a file. */
+      bool isOpen() const {return file_ != NULL;}
+      /** \return File position of the next byte read() returns. */
+      uint32_t position() const {return pos_;}
+     private:
+      SdBaseFile* file_;
+      uint8_t   buf_[SD_READ_AHEAD_BLOCKS][512];
+      uint8_t   head_;         // buffer being read
+      uint8_t   count_;        // buffers filled, head_ included
+      uint16_t  index_;        // next byte in the head buffer
+      uint16_t  end_;          // bytes of the file in the head buffer, 0 if not filled
+      uint32_t  pos_;          // file position of the next byte
+      uint32_t  size_;         // file size when started
+      uint32_t  fetchPos_;     // file position of the next block to fetch
+      uint32_t  cluster_;      // cluster of fetchPos_
+      uint32_t  nextCluster_;  // cluster that follows it in the chain
+      bool load();
+    };
+  #endif  // HAS_SD_READ_AHEAD
+  #if HAS_SD_WRITE_BUFFER
+    //------------------------------------------------------------------------------
+    /**
+     * \class SdWriteBuffer
+     * \brief Write-back buffer for a file written in small pieces.
+     *
+     * Bytes wait in RAM until the buffer is full, then go to the file
+     * as whole blocks, with one multi-block write where the card takes
+     * it. The block in progress and the directory entry are only
+     * written at a flush, so small writes never read and rewrite a
+     * block of the card.
+     */
+    class SdWriteBuffer {
+     public:
+      SdWriteBuffer() : file_(NULL), count_(0) {}
+      void start(SdBaseFile* file) {file_ = file; count_ = 0;}
+      bool write(const void* buf, size_t nbyte);
+      bool flush(const bool sync);
+      bool stop();
+      /** \return True if the buffer has a file. */
+      bool isOpen() const {return file_ != NULL;}
+      /** \return Bytes not written to the file yet. */
+      uint16_t count() const {return count_;}
+     private:
+      SdBaseFile* file_;
+      uint8_t   buf_[SD_WRITE_BUFFER_BLOCKS * 512];
+      uint16_t  count_;        // bytes waiting in buf_
+    };
+  #endif  // HAS_SD_WRITE_BUFFER
   //------------------------------------------------------------------------------
   namespace SdFatUtil {
     void SerialPrint_P(PGM_P str);
@@ -32,9 +32,18 @@
 
   CardReader::CardReader() {
     sdprinting = cardOK = saving = false;
+    #if ENABLED(SD_BINARY_UPLOAD)
+      uploading = false;
+    #endif
+    #if HAS_SD_WRITE_BUFFER
+      logging = false;
+    #endif
     fileSize = 0;
     sdpos = 0;
     workDirDepth = 0;
+    #if HAS_SD_DIR_INDEX
+      dir_index_valid = false;
+    #endif
     ZERO(workDirParents);
 
     autostart_stilltocheck = true; // the SD start is delayed, because otherwise the serial cannot answer fast enough to make contact with the host software.
@@ -47,6 +56,25 @@
     next_autostart_ms = millis() + BOOTSCREEN_TIMEOUT;
   }
 
+  /**
+   * Folders and G-code files are listed, hidden or deleted entries are not.
+   * Takes the name read in fileName and sets filenameIsDir.
+   */
+  bool CardReader::isListed(const dir_t* p) {
+    const uint8_t pn0 = p->name[0];
+    if (pn0 == DIR_NAME_DELETED || pn0 == '.') return false;
+    if (fileName[0] == '.') return false;
+    if (!DIR_IS_FILE_OR_SUBDIR(p) || (p->attributes & DIR_ATT_HIDDEN)) return false;
+
+    filenameIsDir = DIR_IS_SUBDIR(p);
+
+    #if HAS_SD_GCODE_INFO
+      if (filenameIsDir && workDir.firstCluster() == root.firstCluster() && !strcmp_P(fileName, PSTR(GCODE_INFO_DIR))) return false;
+    #endif
+
+    return filenameIsDir || (p->name[8] == 'G' && p->name[9] != '~');
+  }
+
   /**
    * Dive into a folder and recurse depth-first to perform a pre-set operation lsAction:
    *   LS_Count       - Add +1 to nrFiles for every file within the parent
@@ -58,17 +86,9 @@
     
     // Read the next entry from a directory
     while ((p = parent.getLongFilename(p, fileName, 0, NULL)) != NULL) {
-      uint8_t pn0 = p->name[0];
-      if (pn0 == DIR_NAME_FREE) break;
-
-      // ignore hidden or deleted files:
-      if (pn0 == DIR_NAME_DELETED || pn0 == '.') continue;
-      if (fileName[0] == '.') continue;
-      if (!DIR_IS_FILE_OR_SUBDIR(p) || (p->attributes & DIR_ATT_HIDDEN)) continue;
+      if (p->name[0] == DIR_NAME_FREE) break;
+      if (!isListed(p)) continue;
 
-      filenameIsDir = DIR_IS_SUBDIR(p);
-
-      if (!filenameIsDir && (p->name[8] != 'G' || p->name[9] == '~')) continue;
       switch (lsAction) {
         case LS_Count:
           nrFiles++;
@@ -86,6 +106,9 @@
   }
 
   void CardReader::ls()  {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) return;  // The card is in the M577 multi-block write
+    #endif
     root.openRoot(fat.vol());
     root.ls();
     workDir = root;
@@ -93,6 +116,9 @@
   }
 
   void CardReader::mount() {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) return;  // The card is in the M577 multi-block write
+    #endif
     cardOK = false;
     if (root.isOpen()) root.close();
 
@@ -115,6 +141,13 @@
       cardOK = true;
       SERIAL_EM(MSG_SD_CARD_OK);
     }
+    dirChanged();
+    #if HAS_SD_GCODE_INFO
+      gcodeinfo.reset();
+    #endif
+    #if HAS_POWER_LOSS_JOURNAL
+      journal.reset();
+    #endif
     fat.chdir(true);
     root = *fat.vwd();
     workDir = root;
@@ -122,14 +155,40 @@
   }
 
   void CardReader::unmount() {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) finishUpload(false);
+    #endif
+    #if HAS_SD_WRITE_BUFFER
+      // What is in RAM goes before the card does
+      if (logging) stopLog();
+      if (write_buffer.isOpen()) write_buffer.stop();
+    #endif
     cardOK = false;
     sdprinting = false;
+    dirChanged();
+    #if HAS_SD_GCODE_INFO
+      gcodeinfo.reset();
+    #endif
+    #if HAS_POWER_LOSS_JOURNAL
+      journal.reset();
+    #endif
   }
 
   void CardReader::startFileprint() {
     if (cardOK) sdprinting = true;
   }
 
+  void CardReader::setIndex(const uint32_t newpos) {
+    sdpos = newpos;
+    gcode_file.seekSet(sdpos);
+    #if HAS_SD_READ_AHEAD
+      read_ahead.start(&gcode_file, sdpos);
+    #endif
+    #if HAS_SD_GCODE_INFO
+      gcodeinfo.seek(sdpos);
+    #endif
+  }
+
   void CardReader::openAndPrintFile(const char *name) {
     char cmd[4 + strlen(name) + 1]; // Room for "M23 ", filename, and null
     sprintf_P(cmd, PSTR("M23 %s"), name);
@@ -139,6 +198,9 @@
   }
 
   void CardReader::stopSDPrint(const bool store_location /*=false*/) {
+    #if HAS_POWER_LOSS_JOURNAL
+      if (!store_location && sdprinting) journal.finish();
+    #endif
     sdprinting = false;
     if (isFileOpen()) closeFile(store_location);
   }
@@ -156,7 +218,11 @@
     end[1] = '\r';
     end[2] = '\n';
     end[3] = '\0';
-    gcode_file.write(begin);
+    #if HAS_SD_WRITE_BUFFER
+      if (!write_buffer.write(begin, end + 3 - begin)) gcode_file.writeError = true;
+    #else
+      gcode_file.write(begin);
+    #endif
     if (gcode_file.writeError) {
       SERIAL_LM(ER, MSG_SD_ERR_WRITE_TO_FILE);
     }
@@ -179,43 +245,119 @@
   #endif
       
   bool CardReader::selectFile(const char* filename) {
-    const char *oldP = filename;
-
     if (!cardOK) return false;
 
     if (gcode_file.open(curDir, filename, O_READ)) {
-      if ((oldP = strrchr(filename, '/')) != NULL)
-        oldP++;
-      else
-        oldP = filename;
+      fileOpened(filename);
+      return true;
+    }
+    else {
+      SERIAL_EMT(MSG_SD_OPEN_FILE_FAIL, filename);
+      return false;
+    }
+  }
 
-      fileSize = gcode_file.fileSize();
-      sdpos = 0;
+  #if HAS_POWER_LOSS_JOURNAL
 
-      SERIAL_MT(MSG_SD_FILE_OPENED, oldP);
-      SERIAL_EMV(MSG_SD_SIZE, fileSize);
-      SERIAL_EM(MSG_SD_FILE_SELECTED);
+    /**
+     * Open again the file the journal was written for, from where its
+     * folder entry is, if it is still the same file
+     */
+    bool CardReader::reopenFile(const uint32_t dir_block, const uint8_t dir_index, const uint32_t cluster, const uint32_t size, const char* filename) {
+      if (!cardOK) return false;
+
+      gcode_file.close();
+      if (gcode_file.openEntry(fat.vol(), dir_block, dir_index, O_READ)) {
+        if (gcode_file.firstCluster() == cluster && gcode_file.fileSize() == size) {
+          fileOpened(filename);
+          return true;
+        }
+        gcode_file.close();
+      }
+      SERIAL_EMT(MSG_SD_OPEN_FILE_FAIL, filename);
+      return false;
+    }
 
-      for (uint16_t c = 0; c < sizeof(fileName); c++)
-        const_cast<char&>(fileName[c]) = '\0';
-      strncpy(fileName, filename, strlen(filename));
+  #endif
+
+  void CardReader::fileOpened(const char* filename) {
+    const char *oldP = strrchr(filename, '/');
+    if (oldP != NULL)
+      oldP++;
+    else
+      oldP = filename;
 
-      #if ENABLED(JSON_OUTPUT)
+    fileSize = gcode_file.fileSize();
+    sdpos = 0;
+
+    // One FAT walk now, none while printing
+    gcode_file.checkContiguous();
+
+    SERIAL_MT(MSG_SD_FILE_OPENED, oldP);
+    SERIAL_EMV(MSG_SD_SIZE, fileSize);
+    SERIAL_EM(MSG_SD_FILE_SELECTED);
+
+    for (uint16_t c = 0; c < sizeof(fileName); c++)
+      const_cast<char&>(fileName[c]) = '\0';
+    strncpy(fileName, filename, sizeof(fileName) - 1);
+
+    #if HAS_SD_GCODE_INFO
+      gcodeinfo.seek(0);
+      if (gcodeinfo.load(gcode_file)) {
+        objectHeight      = gcodeinfo.info.object_height;
+        firstlayerHeight  = gcodeinfo.info.first_layer_height;
+        layerHeight       = gcodeinfo.info.layer_height;
+        filamentNeeded    = gcodeinfo.info.filament;
+        strcpy(generatedBy, gcodeinfo.info.generated_by);
+      }
+      else
         parsejson(gcode_file);
-      #endif
+    #elif ENABLED(JSON_OUTPUT)
+      parsejson(gcode_file);
+    #endif
 
-      return true;
-    }
-    else {
-      SERIAL_EMT(MSG_SD_OPEN_FILE_FAIL, oldP);
-      return false;
-    }
+    #if HAS_SD_READ_AHEAD
+      read_ahead.start(&gcode_file, gcode_file.curPosition());
+    #endif
+  }
+
+  /**
+   * Bytes of the file from the read position on, straight from
+   * the buffer they are in: 0 at the end of the file, -1 on error.
+   * skipBlock() consumes them, at least one before the next call.
+   */
+  int16_t CardReader::peekBlock(const uint8_t* &src) {
+    #if HAS_SD_READ_AHEAD
+      const int16_t n = read_ahead.peekBlock(src);
+    #else
+      const int16_t n = gcode_file.peekBlock(src);
+    #endif
+    if (!n) sdpos = fileSize;
+    return n;
+  }
+
+  void CardReader::skipBlock(const uint16_t n) {
+    #if HAS_SD_READ_AHEAD
+      read_ahead.skipBlock(n);
+      sdpos = read_ahead.position() - 1;
+    #else
+      gcode_file.skipBlock(n);
+      sdpos = gcode_file.curPosition() - 1;
+    #endif
   }
 
   void CardReader::printStatus() {
     if (cardOK) {
       SERIAL_MV(MSG_SD_PRINTING_BYTE, sdpos);
       SERIAL_EMV(MSG_SD_SLASH, fileSize);
+      #if HAS_SD_PRINT_TIME
+        const int32_t left = isFileOpen() ? gcodeinfo.time_left(sdpos) : -1;
+        if (left >= 0) {
+          char buffer[21];
+          duration_t(left).toString(buffer);
+          SERIAL_EMT("SD print time left: ", buffer);
+        }
+      #endif
     }
     else
       SERIAL_EM(MSG_SD_NOT_PRINTING);
@@ -224,11 +366,20 @@
   void CardReader::startWrite(char *filename, const bool silent/*=false*/) {
     if (!cardOK) return;
 
+    #if HAS_SD_WRITE_BUFFER
+      if (logging) stopLog();
+    #endif
+
+    dirChanged();
     if (!gcode_file.open(curDir, filename, O_CREAT | O_APPEND | O_WRITE | O_TRUNC)) {
       SERIAL_LMT(ER, MSG_SD_OPEN_FILE_FAIL, filename);
     }
     else {
       saving = true;
+      #if HAS_SD_WRITE_BUFFER
+        write_buffer.start(&gcode_file);
+        write_flush_ms = millis() + SD_WRITE_BUFFER_FLUSH * 1000UL;
+      #endif
       if (!silent) {
         SERIAL_EMT(MSG_SD_WRITE_TO_FILE, filename);
         lcd_setstatus(filename);
@@ -239,7 +390,11 @@
   void CardReader::deleteFile(char *filename) {
     if (!cardOK) return;
     sdprinting = false;
+    dirChanged();
     gcode_file.close();
+    #if HAS_SD_GCODE_INFO
+      gcodeinfo.forget(fat.vwd(), filename);
+    #endif
     if (fat.remove(filename)) {
       SERIAL_EMT(MSG_SD_FILE_DELETED, filename);
     }
@@ -252,15 +407,228 @@
   }
 
   void CardReader::finishWrite() {
+    #if HAS_SD_WRITE_BUFFER
+      if (!write_buffer.stop()) SERIAL_LM(ER, MSG_SD_ERR_WRITE_TO_FILE);
+    #endif
     gcode_file.sync();
+    #if HAS_SD_GCODE_INFO
+      gcodeinfo.load(gcode_file);
+    #endif
     gcode_file.close();
     saving = false;
     SERIAL_EM(MSG_SD_FILE_SAVED);
   }
 
+  #if HAS_SD_WRITE_BUFFER
+
+    /**
+     * M928: the commands that run from now on go to filename,
+     * through the write buffer, until M29
+     */
+    void CardReader::startLog(char* filename) {
+      if (!cardOK || saving) return;
+      if (logging) stopLog();
+
+      dirChanged();
+      if (!log_file.open(curDir, filename, O_CREAT | O_APPEND | O_WRITE | O_TRUNC)) {
+        SERIAL_LMT(ER, MSG_SD_OPEN_FILE_FAIL, filename);
+        return;
+      }
+      write_buffer.start(&log_file);
+      write_flush_ms = millis() + SD_WRITE_BUFFER_FLUSH * 1000UL;
+      logging = true;
+      SERIAL_EMT(MSG_SD_WRITE_TO_FILE, filename);
+    }
+
+    void CardReader::stopLog() {
+      if (!logging) return;
+      logging = false;
+      if (!write_buffer.stop()) SERIAL_LM(ER, MSG_SD_ERR_WRITE_TO_FILE);
+      log_file.close();
+      SERIAL_EM(MSG_SD_FILE_SAVED);
+    }
+
+    /**
+     * A line to the log, without line number and checksum.
+     * Nothing reaches the card until a block is full or the
+     * next flush, so it's cheap to call for telemetry too.
+     */
+    void CardReader::logLine(const char* text) {
+      if (!logging) return;
+      const char* begin = text;
+      const char* end = text + strlen(text);
+      if (*text == 'N') {
+        const char* space = strchr(text, ' ');
+        const char* star = strchr(text, '*');
+        if (space) begin = space + 1;
+        if (star && star > begin) end = star;
+      }
+      if (begin < end && (!write_buffer.write(begin, end - begin) || !write_buffer.write("\r\n", 2))) {
+        SERIAL_LM(ER, MSG_SD_ERR_WRITE_TO_FILE);
+        stopLog();
+      }
+    }
+
+    /**
+     * Every SD_WRITE_BUFFER_FLUSH seconds the block in progress and
+     * the directory entry go to the card. The entry is written after
+     * the data, so after a reset the file is whole up to the last flush.
+     */
+    void CardReader::writeIdle() {
+      if (!write_buffer.isOpen() || PENDING(millis(), write_flush_ms)) return;
+      #if ENABLED(SD_BINARY_UPLOAD)
+        if (uploading) return;
+      #endif
+      write_flush_ms = millis() + SD_WRITE_BUFFER_FLUSH * 1000UL;
+      if (!write_buffer.flush(true)) {
+        SERIAL_LM(ER, MSG_SD_ERR_WRITE_TO_FILE);
+        if (logging) stopLog();
+      }
+    }
+
+  #endif // HAS_SD_WRITE_BUFFER
+
+  #if ENABLED(SD_BINARY_UPLOAD)
+
+    /**
+     * Binary upload, frames little endian:
+     *
+     *   UPLOAD_SYNC, sequence (uint16), 512 bytes of the file, crc (uint16)
+     *
+     *   The crc is CRC-16/CCITT-FALSE over the sequence and data bytes.
+     *   The last chunk is padded to 512 bytes.
+     *
+     * The file is allocated contiguous for its size and the chunks go to
+     * the card in one multi-block write. Each frame is answered once the
+     * host may send the next one:
+     *
+     *   Upload ok:<seq>       Written, or a repeat of the last one written
+     *   Upload resend:<seq>   Bad crc, lost bytes or out of order
+     */
+    #define UPLOAD_SYNC         0xFD
+    #define UPLOAD_FRAME_SIZE   (1 + 2 + 512 + 2)
+    #define UPLOAD_BYTE_TIMEOUT 200     // ms, a frame that stops arriving is asked again
+    #define UPLOAD_TIMEOUT      10000   // ms without frames, the upload is given up
+
+    void CardReader::startUpload(const char* filename, const uint32_t size) {
+      if (!cardOK || saving || sdprinting || !size) {
+        SERIAL_LMT(ER, MSG_SD_OPEN_FILE_FAIL, filename);
+        return;
+      }
+
+      if (gcode_file.isOpen()) gcode_file.close();
+      dirChanged();
+      SdBaseFile::remove(curDir, filename);
+
+      uint32_t first, last;
+      if (!gcode_file.createContiguous(curDir, filename, size) || !gcode_file.contiguousRange(&first, &last)) {
+        SERIAL_LMT(ER, MSG_SD_OPEN_FILE_FAIL, filename);
+        if (gcode_file.isOpen()) gcode_file.remove();
+        return;
+      }
+
+      upload_blocks = (size + 511) >> 9;
+      upload_buffer = fat.vol()->cacheClear();
+      if (!upload_buffer || !fat.card()->writeStart(first, upload_blocks)) {
+        SERIAL_LMT(ER, MSG_SD_OPEN_FILE_FAIL, filename);
+        gcode_file.remove();
+        return;
+      }
+
+      upload_next = 0;
+      upload_index = 0;
+      upload_ms = millis();
+      uploading = true;
+      SERIAL_EMT(MSG_SD_WRITE_TO_FILE, filename);
+    }
+
+    void CardReader::uploadByte(const uint8_t c) {
+      upload_ms = millis();
+
+      if (!upload_index) {
+        if (c != UPLOAD_SYNC) return;   // Wait for a frame
+        upload_crc = 0xFFFF;
+        upload_seq = upload_crc_rx = 0;
+      }
+      else if (upload_index < UPLOAD_FRAME_SIZE - 2) {
+        if (upload_index < 3)
+          upload_seq |= (uint16_t)c << ((upload_index - 1) << 3);
+        else
+          upload_buffer->data[upload_index - 3] = c;
+        upload_crc ^= (uint16_t)c << 8;
+        for (uint8_t b = 8; b--;)
+          upload_crc = (upload_crc & 0x8000) ? (upload_crc << 1) ^ 0x1021 : upload_crc << 1;
+      }
+      else
+        upload_crc_rx |= (uint16_t)c << ((upload_index - (UPLOAD_FRAME_SIZE - 2)) << 3);
+
+      if (++upload_index == UPLOAD_FRAME_SIZE) {
+        upload_index = 0;
+        uploadChunk();
+      }
+    }
+
+    void CardReader::uploadIdle() {
+      if (upload_index && ELAPSED(millis(), upload_ms + UPLOAD_BYTE_TIMEOUT)) {
+        upload_index = 0;
+        uploadReply(false, upload_next);
+      }
+      else if (ELAPSED(millis(), upload_ms + UPLOAD_TIMEOUT)) {
+        SERIAL_LM(ER, "Upload timed out");
+        finishUpload(false);
+      }
+    }
+
+    void CardReader::uploadChunk() {
+      if (upload_crc != upload_crc_rx)
+        uploadReply(false, upload_next);
+      else if (upload_next && upload_seq == (uint16_t)(upload_next - 1))
+        uploadReply(true, upload_seq);      // The host missed the answer
+      else if (upload_seq != (uint16_t)upload_next)
+        uploadReply(false, upload_next);
+      else if (!fat.card()->writeData(upload_buffer->data)) {
+        SERIAL_LM(ER, "Upload write error");
+        finishUpload(false);
+      }
+      else {
+        upload_next++;
+        uploadReply(true, upload_seq);
+        if (upload_next == upload_blocks) finishUpload(true);
+      }
+    }
+
+    void CardReader::uploadReply(const bool ok, const uint16_t seq) {
+      // Bytes left of a broken frame would be taken for a new one
+      if (!ok) HAL::serialFlush();
+      upload_ms = millis();
+      if (ok)
+        SERIAL_EMV("Upload ok:", (uint32_t)seq);
+      else
+        SERIAL_EMV("Upload resend:", (uint32_t)seq);
+    }
+
+    void CardReader::finishUpload(const bool ok) {
+      uploading = false;
+      dirChanged();
+      if (fat.card()->writeStop() && ok) {
+        #if HAS_SD_GCODE_INFO
+          gcodeinfo.load(gcode_file);
+        #endif
+        gcode_file.close();
+        SERIAL_EM(MSG_SD_FILE_SAVED);
+      }
+      else {
+        gcode_file.remove();
+        SERIAL_LM(ER, "Upload failed, file removed");
+      }
+    }
+
+  #endif // SD_BINARY_UPLOAD
+
   void CardReader::makeDirectory(char *filename) {
     if (!cardOK) return;
     sdprinting = false;
+    dirChanged();
     gcode_file.close();
     if (fat.mkdir(filename)) {
       SERIAL_EM(MSG_SD_DIRECTORY_CREATED);
@@ -274,7 +642,20 @@
    * Get the name of a file in the current directory by index
    */
   void CardReader::getfilename(uint16_t nr, const char* const match/*=NULL*/) {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) { fileName[0] = '\0'; return; }
+    #endif
     curDir = &workDir;
+    #if HAS_SD_DIR_INDEX
+      if (!match && dirIndexReady()) {
+        fileName[0] = '\0';
+        if (nr < dir_index_count) {
+          filenameIsDir = dir_index[nr].dir;
+          dirIndexName(dir_index[nr], fileName);
+        }
+        return;
+      }
+    #endif
     lsAction = LS_GetFilename;
     nrFiles = nr;
     curDir->rewind();
@@ -282,7 +663,13 @@
   }
 
   uint16_t CardReader::getnrfilenames() {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) return 0;  // The card is in the M577 multi-block write
+    #endif
     curDir = &workDir;
+    #if HAS_SD_DIR_INDEX
+      if (dirIndexReady()) return dir_index_count;
+    #endif
     lsAction = LS_Count;
     nrFiles = 0;
     curDir->rewind();
@@ -290,7 +677,95 @@
     return nrFiles;
   }
 
+  #if HAS_SD_DIR_INDEX
+
+    /**
+     * The index of workDir, built again when workDir is another
+     * folder or the card changed. False if the folder has more
+     * files than the index takes.
+     */
+    bool CardReader::dirIndexReady() {
+      if (!dir_index_valid || dir_index_cluster != workDir.firstCluster()) {
+        dir_index_cluster = workDir.firstCluster();
+        dir_index_full = !dirIndexBuild();
+        dir_index_valid = true;
+      }
+      return !dir_index_full;
+    }
+
+    /**
+     * Read workDir once and keep where each listed file starts
+     */
+    bool CardReader::dirIndexBuild() {
+      SdBaseFile dir = workDir;
+      dir_t* p;
+
+      dir_index_count = 0;
+      dir.rewind();
+      for (;;) {
+        dir_index_t e;
+        e.entry = dir.curPosition() >> 5;
+        if (!(p = dir.getLongFilename(NULL, fileName, 0, NULL)) || p->name[0] == DIR_NAME_FREE) break;
+        if (!isListed(p)) continue;
+        if (dir_index_count == SD_DIR_INDEX_SIZE) return false;
+        e.dir = filenameIsDir;
+
+        #if ENABLED(SD_DIR_INDEX_SORT)
+          // Binary insertion, names are compared only when the keys are the same
+          bool end = false;
+          for (uint8_t i = 0; i < SD_DIR_INDEX_KEY; i++) {
+            if (!fileName[i]) end = true;
+            e.key[i] = end ? '\0' : tolower((uint8_t)fileName[i]);
+          }
+          uint16_t lo = 0, hi = dir_index_count;
+          while (lo < hi) {
+            const uint16_t mid = (lo + hi) >> 1;
+            if (dirIndexCompare(e, fileName, dir_index[mid]) < 0) hi = mid; else lo = mid + 1;
+          }
+          memmove(&dir_index[lo + 1], &dir_index[lo], (dir_index_count - lo) * sizeof(dir_index_t));
+          dir_index[lo] = e;
+        #else
+          dir_index[dir_index_count] = e;
+        #endif
+
+        dir_index_count++;
+      }
+      return true;
+    }
+
+    /**
+     * Read the name of an indexed file, seeking straight to its entry
+     */
+    dir_t* CardReader::dirIndexName(const dir_index_t &e, char* name) {
+      SdBaseFile dir = workDir;
+      *name = '\0';
+      if (!dir.seekSet((uint32_t)e.entry << 5)) return NULL;
+      return dir.getLongFilename(NULL, name, 0, NULL);
+    }
+
+    #if ENABLED(SD_DIR_INDEX_SORT)
+
+      /**
+       * Folders first, then names without case, as strcasecmp
+       */
+      int8_t CardReader::dirIndexCompare(const dir_index_t &a, const char* name, const dir_index_t &b) {
+        if (a.dir != b.dir) return a.dir ? -1 : 1;
+        const int r = memcmp(a.key, b.key, SD_DIR_INDEX_KEY);
+        if (r) return r < 0 ? -1 : 1;
+        if (!a.key[SD_DIR_INDEX_KEY - 1]) return 0;   // Both names are in the keys
+        dirIndexName(b, tempLongFilename);
+        const int c = strcasecmp(name, tempLongFilename);
+        return c < 0 ? -1 : c > 0;
+      }
+
+    #endif
+
+  #endif // HAS_SD_DIR_INDEX
+
   void CardReader::chdir(const char* relpath) {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) return;  // The card is in the M577 multi-block write
+    #endif
     SdBaseFile newfile;
     SdBaseFile* parent = &root;
     if (workDir.isOpen()) parent = &workDir;
@@ -308,6 +783,9 @@
   }
 
   void CardReader::updir() {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) return;  // The card is in the M577 multi-block write
+    #endif
     if (workDirDepth > 0) {
       --workDirDepth;
       workDir = workDirParents[0];
@@ -317,6 +795,9 @@
   }
 
   void CardReader::closeFile(const bool store_location /*=false*/) {
+    #if HAS_SD_READ_AHEAD
+      read_ahead.stop();
+    #endif
     gcode_file.sync();
     gcode_file.close();
     saving = false;
@@ -324,6 +805,7 @@
     SdFile restart_file;
 
     if (store_location) {
+      dirChanged();
       char  bufferFilerestart[100],
             buffer_G1[50],
             buffer_G92_Z[50],
@@ -456,6 +938,9 @@
   }
 
   void CardReader::checkautostart(bool force) {
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (uploading) return;  // The card is in the M577 multi-block write
+    #endif
     if (!force && (!autostart_stilltocheck || next_autostart_ms >= millis()))
       return;
 
@@ -472,6 +957,12 @@
 
   void CardReader::printingHasFinished() {
     stepper.synchronize();
+    #if HAS_POWER_LOSS_JOURNAL
+      journal.finish();
+    #endif
+    #if HAS_SD_READ_AHEAD
+      read_ahead.stop();
+    #endif
     gcode_file.close();
     sdprinting = false;
     if (SD_FINISHED_STEPPERRELEASE) {
@@ -500,43 +991,53 @@
   // Copy date: 27 FEB 2016                                          //
   // --------------------------------------------------------------- //
 
+  #if CPU_ARCH==ARCH_AVR
+    #define GCI_BUF_SIZE 120
+  #else
+    #define GCI_BUF_SIZE 1024
+  #endif
+
   void CardReader::parsejson(SdBaseFile &parser_file) {
     fileSize = parser_file.fileSize();
-    filamentNeeded    = 0.0;
-    objectHeight      = 0.0;
-    firstlayerHeight  = 0.0;
-    layerHeight       = 0.0;
+    parseInfo(parser_file, objectHeight, firstlayerHeight, layerHeight, filamentNeeded, generatedBy);
+  }
+
+  /**
+   * Job info from the slicer comments at the start and the
+   * end of the file, and the height of the last move.
+   */
+  void CardReader::parseInfo(SdBaseFile &parser_file, float &height, float &first_layer, float &layer, float &filament, char* genBy) {
+    filament    = 0.0;
+    height      = 0.0;
+    first_layer = 0.0;
+    layer       = 0.0;
+    strcpy_P(genBy, PSTR("Unknown"));
 
     if (!parser_file.isOpen()) return;
 
     bool genByFound = false, firstlayerHeightFound = false, layerHeightFound = false, filamentNeedFound = false;
 
-    #if CPU_ARCH==ARCH_AVR
-      #define GCI_BUF_SIZE 120
-    #else
-      #define GCI_BUF_SIZE 1024
-    #endif
-
     // READ 4KB FROM THE BEGINNING
     char buf[GCI_BUF_SIZE];
+    buf[GCI_BUF_SIZE - 1] = '\0';
     for (int i = 0; i < 4096; i += GCI_BUF_SIZE - 50) {
       if(!parser_file.seekSet(i)) break;
-      parser_file.read(buf, GCI_BUF_SIZE);
-      if (!genByFound && findGeneratedBy(buf, generatedBy)) genByFound = true;
-      if (!firstlayerHeightFound && findFirstLayerHeight(buf, firstlayerHeight)) firstlayerHeightFound = true;
-      if (!layerHeightFound && findLayerHeight(buf, layerHeight)) layerHeightFound = true;
-      if (!filamentNeedFound && findFilamentNeed(buf, filamentNeeded)) filamentNeedFound = true;
+      parser_file.read(buf, GCI_BUF_SIZE - 1);
+      if (!genByFound && findGeneratedBy(buf, genBy)) genByFound = true;
+      if (!firstlayerHeightFound && findFirstLayerHeight(buf, first_layer)) firstlayerHeightFound = true;
+      if (!layerHeightFound && findLayerHeight(buf, layer)) layerHeightFound = true;
+      if (!filamentNeedFound && findFilamentNeed(buf, filament)) filamentNeedFound = true;
       if(genByFound && layerHeightFound && filamentNeedFound) goto get_objectHeight;
     }
 
     // READ 4KB FROM END
     for (int i = 0; i < 4096; i += GCI_BUF_SIZE - 50) {
       if(!parser_file.seekEnd(-4096 + i)) break;
-      parser_file.read(buf, GCI_BUF_SIZE);
-      if (!genByFound && findGeneratedBy(buf, generatedBy)) genByFound = true;
-      if (!firstlayerHeightFound && findFirstLayerHeight(buf, firstlayerHeight)) firstlayerHeightFound = true;
-      if (!layerHeightFound && findLayerHeight(buf, layerHeight)) layerHeightFound = true;
-      if (!filamentNeedFound && findFilamentNeed(buf, filamentNeeded)) filamentNeedFound = true;
+      parser_file.read(buf, GCI_BUF_SIZE - 1);
+      if (!genByFound && findGeneratedBy(buf, genBy)) genByFound = true;
+      if (!firstlayerHeightFound && findFirstLayerHeight(buf, first_layer)) firstlayerHeightFound = true;
+      if (!layerHeightFound && findLayerHeight(buf, layer)) layerHeightFound = true;
+      if (!filamentNeedFound && findFilamentNeed(buf, filament)) filamentNeedFound = true;
       if(genByFound && layerHeightFound && filamentNeedFound) goto get_objectHeight;
     }
 
@@ -544,8 +1045,8 @@
     // MOVE FROM END UP IN 1KB BLOCKS UP TO 30KB
     for (int i = GCI_BUF_SIZE; i < 30000; i += GCI_BUF_SIZE - 50) {
       if(!parser_file.seekEnd(-i)) break;
-      parser_file.read(buf, GCI_BUF_SIZE);
-      if (findTotalHeight(buf, objectHeight)) break;
+      parser_file.read(buf, GCI_BUF_SIZE - 1);
+      if (findTotalHeight(buf, height)) break;
     }
     parser_file.seekSet(0);
   }
@@ -681,7 +1182,7 @@
   }
 
   bool CardReader::findTotalHeight(char* buf, float &height) {
-    int len = 1024;
+    int len = GCI_BUF_SIZE - 1;
     bool inComment, inRelativeMode = false;
     unsigned int zPos;
     for (int i = len - 5; i > 0; i--) {
@@ -37,12 +37,29 @@
 
   #include "SDFat.h"
 
+  #if HAS_SD_DIR_INDEX
+    typedef struct {
+      uint16_t  entry;                    // Directory entry the file starts at
+      bool      dir;
+      #if ENABLED(SD_DIR_INDEX_SORT)
+        char    key[SD_DIR_INDEX_KEY];    // Start of the name in lower case
+      #endif
+    } dir_index_t;
+  #endif
+
   class CardReader {
 
     public: // PARAMETERS
 
       SdFat fat;
       SdFile gcode_file;
+      #if HAS_SD_READ_AHEAD
+        SdReadAhead read_ahead;
+      #endif
+      #if HAS_SD_WRITE_BUFFER
+        SdWriteBuffer write_buffer;       // Of the M28 or M928 file
+        SdFile log_file;
+      #endif
       SdBaseFile root,
                 *curDir,
                  workDir,
@@ -58,6 +75,14 @@
            cardOK,
            filenameIsDir;
 
+      #if ENABLED(SD_BINARY_UPLOAD)
+        bool uploading;
+      #endif
+
+      #if HAS_SD_WRITE_BUFFER
+        bool logging;
+      #endif
+
       uint32_t fileSize,
                sdpos;
 
@@ -79,6 +104,7 @@
       void ls();
       void getfilename(uint16_t nr, const char* const match = NULL);
       void startFileprint();
+      void setIndex(const uint32_t newpos);
       void openAndPrintFile(const char* name);
       void stopSDPrint(const bool store_location = false);
       void write_command(char* buf);
@@ -94,6 +120,27 @@
       void updir();
       void setroot();
       void setlast();
+      int16_t peekBlock(const uint8_t* &src);
+      void skipBlock(const uint16_t n);
+
+      #if ENABLED(SD_BINARY_UPLOAD)
+        void startUpload(const char* filename, const uint32_t size);
+        void uploadByte(const uint8_t c);
+        void uploadIdle();
+      #endif
+
+      #if HAS_SD_WRITE_BUFFER
+        void startLog(char* filename);
+        void stopLog();
+        void logLine(const char* text);
+        void writeIdle();
+      #endif
+
+      #if HAS_POWER_LOSS_JOURNAL
+        bool reopenFile(const uint32_t dir_block, const uint8_t dir_index, const uint32_t cluster, const uint32_t size, const char* filename);
+        FORCE_INLINE bool readBlock(const uint32_t block, uint8_t* dst) { return fat.card()->readBlock(block, dst); }
+        FORCE_INLINE bool writeBlock(const uint32_t block, const uint8_t* src) { return fat.card()->writeBlock(block, src); }
+      #endif
 
       #if HAS_EEPROM_SD
         bool write_data(SdFile* currentfile, const uint8_t value);
@@ -119,14 +166,28 @@
 
       uint16_t getnrfilenames();
 
+      void parseInfo(SdBaseFile &parser_file, float &height, float &first_layer, float &layer, float &filament, char* genBy);
+
       FORCE_INLINE void pauseSDPrint() { sdprinting = false; }
-      FORCE_INLINE void setIndex(uint32_t newpos) { sdpos = newpos; gcode_file.seekSet(sdpos); }
       FORCE_INLINE bool isFileOpen() { return gcode_file.isOpen(); }
       FORCE_INLINE bool eof() { return sdpos >= fileSize; }
-      FORCE_INLINE int16_t get() { sdpos = gcode_file.curPosition(); return (int16_t)gcode_file.read(); }
+      #if HAS_SD_READ_AHEAD
+        FORCE_INLINE int16_t get() { sdpos = read_ahead.position(); return read_ahead.read(); }
+        FORCE_INLINE uint32_t readPosition() { return read_ahead.position(); }
+        FORCE_INLINE void prefetch() { if (sdprinting && read_ahead.isOpen()) read_ahead.idleFill(); }
+      #else
+        FORCE_INLINE int16_t get() { sdpos = gcode_file.curPosition(); return (int16_t)gcode_file.read(); }
+        FORCE_INLINE uint32_t readPosition() { return gcode_file.curPosition(); }
+      #endif
       FORCE_INLINE uint8_t percentDone() { return (isFileOpen() && fileSize) ? sdpos / ((fileSize + 99) / 100) : 0; }
       FORCE_INLINE char* getWorkDirName() { workDir.getFilename(fileName); return fileName; }
 
+      #if HAS_SD_DIR_INDEX
+        FORCE_INLINE void dirChanged() { dir_index_valid = false; }
+      #else
+        FORCE_INLINE void dirChanged() {}
+      #endif
+
       //files init.g on the sd card are performed in a row
       //this is to delay autostart and hence the initialization of the sd card to some seconds after the normal init, so the device is available quickly after a reset
       void checkautostart(bool x);
@@ -135,16 +196,54 @@
 
     private: // PARAMETERS
 
-      Sd2Card card;
-
       uint16_t workDirDepth;
       millis_t next_autostart_ms;
       uint16_t nrFiles; // counter for the files in the current directory and recycled as position counter for getting the nrFiles'th name in the directory.
       LsAction lsAction; //stored for recursion.
       bool autostart_stilltocheck; //the sd start is delayed, because otherwise the serial cannot answer fast enought to make contact with the hostsoftware.
 
+      #if HAS_SD_DIR_INDEX
+        dir_index_t dir_index[SD_DIR_INDEX_SIZE]; // Files of workDir in list order
+        uint16_t  dir_index_count;
+        uint32_t  dir_index_cluster;  // First cluster of the folder indexed
+        bool      dir_index_valid,    // False after a change to the card
+                  dir_index_full;     // More files than the index takes
+      #endif
+
+      #if ENABLED(SD_BINARY_UPLOAD)
+        cache_t*  upload_buffer;      // Volume cache, free while the card takes the file
+        uint32_t  upload_blocks,      // Blocks of the file
+                  upload_next;        // Block the next chunk goes to
+        uint16_t  upload_index,       // Bytes of the frame received
+                  upload_seq,         // Sequence number of the frame
+                  upload_crc,         // Crc computed
+                  upload_crc_rx;      // Crc sent
+        millis_t  upload_ms;          // Last byte received
+      #endif
+
+      #if HAS_SD_WRITE_BUFFER
+        millis_t  write_flush_ms;     // Next periodic flush
+      #endif
+
     private: // FUNCTIONS
 
+      #if ENABLED(SD_BINARY_UPLOAD)
+        void uploadChunk();
+        void uploadReply(const bool ok, const uint16_t seq);
+        void finishUpload(const bool ok);
+      #endif
+
+      #if HAS_SD_DIR_INDEX
+        bool dirIndexReady();
+        bool dirIndexBuild();
+        dir_t* dirIndexName(const dir_index_t &e, char* name);
+        #if ENABLED(SD_DIR_INDEX_SORT)
+          int8_t dirIndexCompare(const dir_index_t &a, const char* name, const dir_index_t &b);
+        #endif
+      #endif
+
+      void fileOpened(const char* filename);
+      bool isListed(const dir_t* p);
       void lsDive(SdBaseFile parent, const char* const match = NULL);
       void parsejson(SdBaseFile &parser_file);
       bool findGeneratedBy(char* buf, char* genBy);
@@ -0,0 +1,438 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * gcodeinfo.cpp
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../base.h"
+
+#if HAS_SD_GCODE_INFO
+
+  GcodeInfo gcodeinfo;
+
+  gcode_info_t  GcodeInfo::info;
+  gcode_layer_t GcodeInfo::layer[SD_GCODE_INFO_LAYERS];
+  bool          GcodeInfo::ready = false;
+
+  SdBaseFile    GcodeInfo::scan_file;
+  uint32_t      GcodeInfo::cluster = 0,
+                GcodeInfo::line_pos,
+                GcodeInfo::print_pos = 0;
+  gcode_layer_t GcodeInfo::z_start;
+  float         GcodeInfo::scan_z,
+                GcodeInfo::scan_e,
+                GcodeInfo::layer_z;
+  #if HAS_SD_PRINT_TIME
+    float       GcodeInfo::scan_xy[2],
+                GcodeInfo::scan_f;
+  #endif
+  char          GcodeInfo::line[MAX_CMD_SIZE];
+  uint8_t       GcodeInfo::line_len,
+                GcodeInfo::tool;
+  bool          GcodeInfo::scanning = false,
+                GcodeInfo::followed = false,
+                GcodeInfo::comment,
+                GcodeInfo::relative,
+                GcodeInfo::relative_e;
+
+  bool GcodeInfo::load(SdBaseFile &file) {
+    dir_t d;
+    if (!file.isOpen() || !file.firstCluster() || !file.dirEntry(&d)) return false;
+
+    // Already in memory
+    if (cluster == file.firstCluster() && info.file_size == file.fileSize()
+        && info.write_date == d.lastWriteDate && info.write_time == d.lastWriteTime) return true;
+
+    scanning = ready = false;
+    cluster = file.firstCluster();
+
+    // From the sidecar
+    SdBaseFile side;
+    if (sidecar(side, cluster, O_READ)) {
+      const uint16_t table = side.read(&info, sizeof(info)) == (int)sizeof(info) ? info.layer_count * sizeof(gcode_layer_t) : 0;
+      if (table && info.version == GCODE_INFO_VERSION && info.file_size == file.fileSize()
+          && info.write_date == d.lastWriteDate && info.write_time == d.lastWriteTime
+          && info.layer_count <= SD_GCODE_INFO_LAYERS && side.read(layer, table) == table) {
+        side.close();
+        return ready = true;
+      }
+      side.close();
+    }
+
+    // A copy reads the file, it may be open for writing only
+    scan_file = file;
+    scan_file.flags_ = O_READ | (file.flags_ & SdBaseFile::F_FILE_CONTIGUOUS);
+
+    info.version    = GCODE_INFO_VERSION;
+    info.file_size  = file.fileSize();
+    info.write_date = d.lastWriteDate;
+    info.write_time = d.lastWriteTime;
+    card.parseInfo(scan_file, info.object_height, info.first_layer_height, info.layer_height, info.filament, info.generated_by);
+
+    info.lines = 0;
+    info.layers = info.layer_count = 0;
+    info.layer_step = 1;
+    info.print_time = 0.0;
+    scan_z = scan_e = 0.0;
+    #if HAS_SD_PRINT_TIME
+      scan_xy[0] = scan_xy[1] = 0.0;
+      scan_f = MMM_TO_MMS(1500.0);
+      printtime.reset();
+    #endif
+    layer_z = -1.0;
+    line_pos = 0;
+    line_len = tool = 0;
+    comment = relative = relative_e = followed = false;
+    z_start.pos = 0;
+    z_start.z = z_start.e = z_start.time = 0.0;
+    z_start.tool = 0;
+    z_start.relative = z_start.relative_e = false;
+    scanning = scan_file.seekSet(0);
+    return true;
+  }
+
+  void GcodeInfo::idle() {
+    if (!scanning || !card.cardOK || card.sdprinting || card.saving) return;
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (card.uploading) return;
+    #endif
+
+    // Go on after the last line the print scanned
+    if (followed) {
+      followed = comment = false;
+      line_len = 0;
+      if (!scan_file.seekSet(line_pos)) {
+        scanning = false;
+        return;
+      }
+    }
+
+    const uint8_t* src;
+    const uint32_t pos = scan_file.curPosition();
+    const int16_t n = scan_file.peekBlock(src);
+
+    if (n < 0) {
+      scanning = false;
+      return;
+    }
+
+    if (!n) {
+      if (line_len) scan_line();
+      scanning = false;
+      ready = true;
+      #if HAS_SD_PRINT_TIME
+        info.print_time = printtime.finish();
+      #endif
+      save();
+      return;
+    }
+
+    for (int16_t i = 0; i < n; i++) {
+      const char c = src[i];
+      if (c == '\n' || c == '\r') {
+        if (line_len) scan_line();
+        line_len = 0;
+        comment = false;
+        line_pos = pos + i + 1;
+      }
+      else if (c == ';')
+        comment = true;
+      else if (!comment && line_len < sizeof(line) - 1 && (line_len || c != ' '))
+        line[line_len++] = c;
+    }
+    scan_file.skipBlock(n);
+  }
+
+  /**
+   * The print reads the file with nothing between print_pos and pos
+   * but comments and blank lines. When that covers where the scan is
+   * up to, the line is scanned here and not read twice.
+   */
+  void GcodeInfo::follow(const char* cmd, const uint32_t pos, const uint32_t next) {
+    if (scanning && print_pos <= line_pos && pos >= line_pos && cluster == card.gcode_file.firstCluster()) {
+      while (*cmd == ' ') cmd++;
+      strncpy(line, cmd, sizeof(line) - 1);
+      line_len = strlen(line);
+      scan_line();
+      line_pos = next;
+      line_len = 0;
+      comment = false;
+      followed = true;
+    }
+    print_pos = next;
+  }
+
+  void GcodeInfo::forget(SdBaseFile* dir, const char* name) {
+    SdBaseFile file, side;
+    if (!file.open(dir, name, O_READ)) return;
+    const uint32_t clust = file.firstCluster();
+    file.close();
+    if (clust == cluster) reset();
+    if (clust && sidecar(side, clust, O_WRITE)) side.remove();
+  }
+
+  void GcodeInfo::report(SdBaseFile* dir, const char* name) {
+    SdBaseFile file;
+    if (!card.cardOK || !name || !file.open(dir, name, O_READ) || !load(file)) {
+      SERIAL_EM("{\"err\":1}");
+      return;
+    }
+    file.close();
+
+    SERIAL_MV("{\"err\":0,\"size\":", info.file_size);
+    SERIAL_MV(",\"height\":", info.object_height);
+    SERIAL_MV(",\"firstLayerHeight\":", info.first_layer_height);
+    SERIAL_MV(",\"layerHeight\":", info.layer_height);
+    SERIAL_MV(",\"filament\":[", info.filament);
+    SERIAL_MT("],\"generatedBy\":\"", info.generated_by);
+    SERIAL_CHR('"');
+    if (ready) {
+      SERIAL_MV(",\"lines\":", info.lines);
+      SERIAL_MV(",\"layers\":", info.layers);
+      if (info.print_time) SERIAL_MV(",\"printTime\":", (unsigned long)info.print_time);
+    }
+    SERIAL_EM("}");
+  }
+
+  int16_t GcodeInfo::find_layer(const uint16_t n) {
+    if (!info.layer_count) return -1;
+    const uint16_t i = n / info.layer_step;
+    if (i < info.layer_count) return i;
+    // Past the end of a table still being built, the layer is not known yet
+    return ready ? info.layer_count - 1 : -1;
+  }
+
+  int16_t GcodeInfo::find_z(const float &z) {
+    if (!info.layer_count) return -1;
+    // The last entry at or below z, so no layer between it and z is left out
+    uint16_t i = 0;
+    while (i + 1 < info.layer_count && layer[i + 1].z <= z + 0.001) i++;
+    // Above the end of a table still being built, the layer is not known yet
+    return (ready || i + 1 < info.layer_count || layer[i].z >= z - 0.001) ? i : -1;
+  }
+
+  #if HAS_SD_PRINT_TIME
+
+    int32_t GcodeInfo::time_left(const uint32_t sdpos) {
+      if (!ready || !info.print_time || cluster != card.gcode_file.firstCluster()) return -1;
+
+      // Time at sdpos, linear in the bytes between the layer starts around it
+      uint32_t  pos0 = 0, pos1 = info.file_size;
+      float     time0 = 0.0, time1 = info.print_time;
+      for (uint16_t i = 0; i < info.layer_count; i++) {
+        if (layer[i].pos > sdpos) {
+          pos1 = layer[i].pos;
+          time1 = layer[i].time;
+          break;
+        }
+        pos0 = layer[i].pos;
+        time0 = layer[i].time;
+      }
+      const float t = pos1 > pos0 ? time0 + (time1 - time0) * (float)(MIN(sdpos, pos1) - pos0) / (float)(pos1 - pos0) : time0;
+      return t < info.print_time ? (int32_t)(info.print_time - t) : 0;
+    }
+
+  #endif
+
+  void GcodeInfo::report_layers() {
+    SERIAL_MV("Layers:", info.layers);
+    SERIAL_MV(" step:", info.layer_step);
+    if (!ready) SERIAL_MSG(" (scanning)");
+    SERIAL_EOL();
+    for (uint16_t i = 0; i < info.layer_count; i++) {
+      const gcode_layer_t &l = layer[i];
+      SERIAL_MV("L", (int)(i * info.layer_step));
+      SERIAL_MV(" Z:", l.z, 3);
+      SERIAL_MV(" E:", l.e, 3);
+      SERIAL_MV(" T:", (int)l.tool);
+      #if HAS_SD_PRINT_TIME
+        SERIAL_MV(" time:", (unsigned long)l.time);
+      #endif
+      SERIAL_EMV(" pos:", l.pos);
+    }
+  }
+
+  void GcodeInfo::print_from(const int16_t index) {
+    const gcode_layer_t &l = layer[index];
+
+    SERIAL_MV("Print from layer ", (int)(index * info.layer_step));
+    SERIAL_MV(" Z:", l.z, 3);
+    SERIAL_EMV(" pos:", l.pos);
+
+    stepper.synchronize();
+    #if EXTRUDERS > 1
+      if (l.tool < EXTRUDERS && l.tool != tools.active_extruder) tools.change(l.tool, 0.0, true);
+    #endif
+
+    // Up to the layer before the file moves over the print
+    if (mechanics.current_position[Z_AXIS] < l.z) mechanics.do_blocking_move_to_z(l.z);
+
+    printer.relative_mode = l.relative;
+    printer.axis_relative_modes[E_AXIS] = l.relative_e;
+    mechanics.current_position[E_AXIS] = l.e;
+    mechanics.sync_plan_position_e();
+
+    card.setIndex(l.pos);
+    card.startFileprint();
+    print_job_counter.start();
+  }
+
+  bool GcodeInfo::sidecar(SdBaseFile &file, const uint32_t clust, const uint8_t oflag) {
+    SdBaseFile dir;
+    if (!dir.open(&card.root, GCODE_INFO_DIR, O_READ)
+        && (!(oflag & O_CREAT) || !dir.mkdir(&card.root, GCODE_INFO_DIR))) return false;
+
+    char name[13];
+    sprintf_P(name, PSTR("%08lX.GCI"), (unsigned long)clust);
+    return file.open(&dir, name, oflag);
+  }
+
+  bool GcodeInfo::save() {
+    SdBaseFile side;
+    if (!sidecar(side, cluster, O_CREAT | O_WRITE | O_TRUNC)) return false;
+    const int table = info.layer_count * sizeof(gcode_layer_t);
+    const bool ok = side.write(&info, sizeof(info)) == (int)sizeof(info)
+                 && (!table || side.write(layer, table) == table);
+    return side.close() && ok;
+  }
+
+  /**
+   * The moves of a line, for the layer starts. A layer starts at the
+   * line that moved to a Z above the last layer, once the nozzle
+   * extrudes there. Z hops and travel moves are not layers. E, tool
+   * and modes are kept as they were before that line.
+   */
+  void GcodeInfo::scan_line() {
+    line[line_len] = '\0';
+    info.lines++;
+
+    char *p = line;
+    if (*p == 'N') {
+      GCodeParser::parse_long(p + 1, &p);
+      while (*p == ' ') p++;
+    }
+
+    const char letter = *p;
+    const int32_t code = GCodeParser::parse_long(p + 1, &p);
+
+    if (letter == 'T') {
+      tool = code;
+      return;
+    }
+    if (letter == 'M') {
+      if (code == 82) relative_e = false;
+      else if (code == 83) relative_e = true;
+      return;
+    }
+    if (letter != 'G') return;
+
+    switch (code) {
+      case 90: relative = relative_e = false; return;
+      case 91: relative = relative_e = true; return;
+      case 0: case 1: case 92: break;
+      #if HAS_SD_PRINT_TIME
+        case 4:
+          for (; *p; p++) {
+            if (*p == 'P') printtime.dwell(GCodeParser::parse_float(p + 1) * 0.001);
+            else if (*p == 'S') printtime.dwell(GCodeParser::parse_float(p + 1));
+          }
+          return;
+      #endif
+      default: return;
+    }
+
+    const float line_e = scan_e;
+    float de = 0.0;
+    #if HAS_SD_PRINT_TIME
+      const float from[XYZ] = { scan_xy[0], scan_xy[1], scan_z };
+    #endif
+    for (; *p; p++) {
+      #if HAS_SD_PRINT_TIME
+        if (*p == 'X' || *p == 'Y') {
+          const float v = GCodeParser::parse_float(p + 1);
+          float &xy = scan_xy[*p - 'X'];
+          xy = (relative && code != 92) ? xy + v : v;
+          continue;
+        }
+        if (*p == 'F') {
+          if (code != 92) scan_f = MMM_TO_MMS(GCodeParser::parse_float(p + 1));
+          continue;
+        }
+      #endif
+      if (*p != 'Z' && *p != 'E') continue;
+      const float v = GCodeParser::parse_float(p + 1);
+      if (*p == 'Z') {
+        const float z = (relative && code != 92) ? scan_z + v : v;
+        if (z != scan_z) {
+          scan_z = z;
+          z_start.pos = line_pos;
+          z_start.z = z;
+          z_start.e = line_e;
+          z_start.tool = tool;
+          z_start.relative = relative;
+          z_start.relative_e = relative_e;
+          #if HAS_SD_PRINT_TIME
+            z_start.time = printtime.elapsed();
+          #endif
+        }
+      }
+      else if (code == 92)
+        scan_e = v;
+      else {
+        de = relative_e ? v : v - scan_e;
+        scan_e += de;
+      }
+    }
+
+    #if HAS_SD_PRINT_TIME
+      if (code != 92) {
+        const float delta[XYZE] = { scan_xy[0] - from[X_AXIS], scan_xy[1] - from[Y_AXIS], scan_z - from[Z_AXIS], de };
+        printtime.move(delta, scan_f, MIN(tool, EXTRUDERS - 1));
+      }
+    #endif
+
+    if (de > 0.0 && scan_z > layer_z + 0.001) {
+      layer_z = scan_z;
+      add_layer();
+    }
+  }
+
+  /**
+   * Every layer_step-th layer goes in the table. When it is full
+   * every other entry is dropped and the step doubles.
+   */
+  void GcodeInfo::add_layer() {
+    if (!(info.layers % info.layer_step)) {
+      if (info.layer_count == SD_GCODE_INFO_LAYERS) {
+        for (uint16_t i = 0; i < SD_GCODE_INFO_LAYERS / 2; i++) layer[i] = layer[i << 1];
+        info.layer_count = SD_GCODE_INFO_LAYERS / 2;
+        info.layer_step <<= 1;
+      }
+      if (!(info.layers % info.layer_step)) layer[info.layer_count++] = z_start;
+    }
+    info.layers++;
+  }
+
+#endif // HAS_SD_GCODE_INFO
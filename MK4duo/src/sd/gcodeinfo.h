@@ -0,0 +1,186 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * gcodeinfo.h
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#ifndef _GCODEINFO_H_
+#define _GCODEINFO_H_
+
+#if HAS_SD_GCODE_INFO
+
+  #define GCODE_INFO_DIR      "JOBINFO"
+  #define GCODE_INFO_VERSION  3
+
+  /**
+   * Header of JOBINFO/<first cluster>.GCI, followed by layer_count
+   * layer starts. It belongs to the file with that first cluster
+   * while size and write time are the same.
+   */
+  typedef struct {
+    uint8_t   version;
+    uint32_t  file_size;
+    uint16_t  write_date,
+              write_time;
+    float     object_height,
+              first_layer_height,
+              layer_height,
+              filament;
+    char      generated_by[GENBY_SIZE];
+    uint32_t  lines;              // Lines with a command
+    uint16_t  layers,             // Layers found
+              layer_step,         // Layers from one table entry to the next
+              layer_count;        // Entries in the table
+    float     print_time;         // Seconds, 0 if not estimated
+  } gcode_info_t;
+
+  /**
+   * Where a layer starts and what the file set before it,
+   * enough to go on from there without the lines before.
+   */
+  typedef struct {
+    uint32_t  pos;                // Line that moves to the layer
+    float     z,                  // Height of the layer
+              e,                  // E before that line, as the file counts it
+              time;               // Seconds of print before that line, 0 if not estimated
+    uint8_t   tool;
+    bool      relative,
+              relative_e;
+  } gcode_layer_t;
+
+  class GcodeInfo {
+
+    public: /** Constructor */
+
+      GcodeInfo() {}
+
+    public: /** Public Parameters */
+
+      static gcode_info_t   info;                             // Of the file last loaded
+      static gcode_layer_t  layer[SD_GCODE_INFO_LAYERS];      // Start of layer n * layer_step
+      static bool           ready;                            // Lines and layers are known
+
+    private: /** Private Parameters */
+
+      static SdBaseFile     scan_file;
+      static uint32_t       cluster,          // First cluster of the file of info
+                            line_pos,         // Where the line being scanned starts
+                            print_pos;        // Where the print read up to, comments aside
+      static gcode_layer_t  z_start;          // Line that moved to the current Z
+      static float          scan_z,
+                            scan_e,
+                            layer_z;
+      #if HAS_SD_PRINT_TIME
+        static float        scan_xy[2],
+                            scan_f;           // mm/s
+      #endif
+      static char           line[MAX_CMD_SIZE];
+      static uint8_t        line_len,
+                            tool;
+      static bool           scanning,
+                            followed,         // The print scanned lines, scan_file is behind
+                            comment,
+                            relative,
+                            relative_e;
+
+    public: /** Public Function */
+
+      /**
+       * Info of a file, from its sidecar or read from the slicer comments.
+       * In the second case lines and layers are scanned in idle().
+       */
+      static bool load(SdBaseFile &file);
+
+      /**
+       * Forget the file of info, after the card changed
+       */
+      FORCE_INLINE static void reset() { cluster = 0; scanning = ready = false; }
+
+      /**
+       * Scan a block of the file, not while the card is busy
+       */
+      static void idle();
+
+      /**
+       * Remove the sidecar of a file that is going to be deleted
+       */
+      static void forget(SdBaseFile* dir, const char* name);
+
+      /**
+       * M36 JSON report of a file in dir
+       */
+      static void report(SdBaseFile* dir, const char* name);
+
+      /**
+       * Scan a line the print read at pos, when the scan is up to it,
+       * so the first print of a file also builds its table
+       */
+      static void follow(const char* cmd, const uint32_t pos, const uint32_t next);
+
+      /**
+       * The print goes on from pos
+       */
+      FORCE_INLINE static void seek(const uint32_t pos) { print_pos = pos; }
+
+      /**
+       * Table entry of the nearest layer at or before a layer number,
+       * or at or below a height, -1 if not scanned
+       */
+      static int16_t find_layer(const uint16_t n);
+      static int16_t find_z(const float &z);
+
+      #if HAS_SD_PRINT_TIME
+        /**
+         * Seconds left of the print, from the layer times around sdpos,
+         * or -1 if the file printing has no estimate
+         */
+        static int32_t time_left(const uint32_t sdpos);
+      #endif
+
+      /**
+       * M415 list of the table
+       */
+      static void report_layers();
+
+      /**
+       * Print the open file from a table entry on, with the
+       * E, tool and modes the file had there
+       */
+      static void print_from(const int16_t index);
+
+    private: /** Private Function */
+
+      static bool sidecar(SdBaseFile &file, const uint32_t clust, const uint8_t oflag);
+      static bool save();
+      static void scan_line();
+      static void add_layer();
+
+  };
+
+  extern GcodeInfo gcodeinfo;
+
+#endif // HAS_SD_GCODE_INFO
+
+#endif /* _GCODEINFO_H_ */
@@ -0,0 +1,500 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * journal.cpp
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../base.h"
+
+#if HAS_POWER_LOSS_JOURNAL
+
+  #if ENABLED(ARDUINO_ARCH_SAM)
+    #include <avr/dtostrf.h>
+  #endif
+
+  #define JOURNAL_SIZE    ((uint32_t)(POWER_LOSS_JOURNAL_RECORDS) * 512)
+  #define JOURNAL_Z_LIFT  5   // mm over the print while XY are homed
+
+  static_assert(sizeof(journal_record_t) <= 512, "The journal record must fit a sector, reduce JOURNAL_NAME_SIZE.");
+
+  Journal journal;
+
+  journal_record_t Journal::rec;
+
+  uint32_t  Journal::cmd_sdpos    = JOURNAL_NO_SDPOS,
+            Journal::first_block  = 0,
+            Journal::seq;
+  float     Journal::cmd_position[XYZE],
+            Journal::max_z;
+  millis_t  Journal::next_ms      = 0,
+            Journal::write_ms;
+  uint8_t   Journal::slot,
+            Journal::resume_step  = 0,
+            Journal::resume_index;
+  bool      Journal::active       = false;
+
+  /**
+   * Steps of the resume, the HEAT, WAIT and FAN ones take a line for each heater or fan
+   */
+  enum ResumeStepEnum : uint8_t {
+    RESUME_NONE, RESUME_G90, RESUME_HEAT, RESUME_SET_Z, RESUME_LIFT, RESUME_HOME, RESUME_WAIT,
+    RESUME_TOOL, RESUME_LEVEL, RESUME_PURGE_E, RESUME_PURGE, RESUME_XY, RESUME_Z, RESUME_E,
+    RESUME_FAN, RESUME_SPEED, RESUME_FEEDRATE, RESUME_MODE, RESUME_MODE_E, RESUME_CONTINUE, RESUME_END
+  };
+
+  static uint16_t journal_crc(const uint8_t* data, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+      crc ^= (uint16_t)*data++ << 8;
+      for (uint8_t b = 8; b--;)
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+  }
+
+  static char* add_value(char* p, const char letter, const float &value) {
+    *p++ = ' ';
+    *p++ = letter;
+    dtostrf(value, 1, 3, p);
+    return p + strlen(p);
+  }
+
+  void Journal::command(const char* sdpos) {
+    if (sdpos) {
+      memcpy(&cmd_sdpos, sdpos, sizeof(cmd_sdpos));
+      if (cmd_sdpos != JOURNAL_NO_SDPOS) COPY_ARRAY(cmd_position, mechanics.current_position);
+    }
+    else
+      cmd_sdpos = JOURNAL_NO_SDPOS;
+  }
+
+  void Journal::plan(block_t* block) {
+    block->sdpos = cmd_sdpos;
+    if (cmd_sdpos != JOURNAL_NO_SDPOS) COPY_ARRAY(block->sd_position, cmd_position);
+  }
+
+  /**
+   * Once a second look at the oldest planned block, or the next queued
+   * command when nothing moves, and write a record when it is due.
+   */
+  void Journal::idle() {
+
+    if (resume_step) {
+      char cmd[40];
+      if (resume_line(cmd) && commands.enqueue_and_echo_command(cmd)) {
+        if (resume_step == RESUME_HEAT || resume_step == RESUME_WAIT || resume_step == RESUME_FAN)
+          resume_index++;
+        else {
+          resume_step++;
+          resume_index = 0;
+        }
+      }
+      return;
+    }
+
+    if (!card.sdprinting || card.saving) return;
+    #if ENABLED(SD_BINARY_UPLOAD)
+      if (card.uploading) return;
+    #endif
+
+    const millis_t now = millis();
+    if (PENDING(now, next_ms)) return;
+    next_ms = now + 1000UL;
+
+    if (!active) {
+      active = true;
+      max_z = -99999.0;
+      write_ms = now - (POWER_LOSS_JOURNAL_TIME) * 1000UL;
+      if (!open()) SERIAL_LM(ER, "Journal not available");
+    }
+    if (!first_block) return;
+
+    uint32_t sdpos = JOURNAL_NO_SDPOS;
+    float position[XYZE];
+
+    CRITICAL_SECTION_START
+      const bool moving = planner.blocks_queued();
+      if (moving) {
+        const block_t &block = planner.block_buffer[planner.block_buffer_tail];
+        sdpos = block.sdpos;
+        COPY_ARRAY(position, block.sd_position);
+      }
+    CRITICAL_SECTION_END
+
+    if (!moving) {
+      sdpos = commands.queued_sdpos();
+      COPY_ARRAY(position, mechanics.current_position);
+    }
+
+    // Moves of commands not from the file, nothing to go back to
+    if (sdpos == JOURNAL_NO_SDPOS) return;
+
+    bool due = ELAPSED(now, write_ms + (POWER_LOSS_JOURNAL_TIME) * 1000UL);
+    #if ENABLED(POWER_LOSS_JOURNAL_LAYER)
+      if (position[Z_AXIS] > max_z + 0.001) due = true;
+    #endif
+    if (!due) return;
+
+    write(sdpos, position);
+    write_ms = now;
+    NOLESS(max_z, position[Z_AXIS]);
+  }
+
+  void Journal::finish() {
+    active = false;
+    if (first_block) write(JOURNAL_NO_SDPOS, mechanics.current_position);
+  }
+
+  /**
+   * JOURNAL.BIN is allocated contiguous in the root folder, then its
+   * records are read to go on after the newest one
+   */
+  bool Journal::open() {
+    if (first_block) return true;
+    if (!card.cardOK) return false;
+
+    SdBaseFile file;
+    uint32_t first = 0, last;
+
+    if (file.open(&card.root, JOURNAL_FILE, O_RDWR)) {
+      if (file.fileSize() < JOURNAL_SIZE || !file.contiguousRange(&first, &last)) {
+        card.dirChanged();
+        file.remove();
+        first = 0;
+      }
+      else
+        file.close();
+    }
+
+    cache_t* buffer = card.fat.vol()->cacheClear();
+    if (!buffer) return false;
+
+    seq = 0;
+    slot = 0;
+
+    if (!first) {
+      card.dirChanged();
+      if (!file.createContiguous(&card.root, JOURNAL_FILE, JOURNAL_SIZE) || !file.contiguousRange(&first, &last)) {
+        if (file.isOpen()) file.remove();
+        return false;
+      }
+      file.close();
+
+      // The sectors hold what was there before
+      buffer = card.fat.vol()->cacheClear();
+      memset(buffer->data, 0, 512);
+      for (uint8_t i = 0; i < POWER_LOSS_JOURNAL_RECORDS; i++)
+        if (!card.writeBlock(first + i, buffer->data)) return false;
+    }
+    else {
+      for (uint8_t i = 0; i < POWER_LOSS_JOURNAL_RECORDS; i++) {
+        if (!card.readBlock(first + i, buffer->data)) return false;
+        const journal_record_t &r = *(journal_record_t*)buffer->data;
+        if (valid(r) && r.seq > seq) {
+          seq = r.seq;
+          slot = i + 1 < POWER_LOSS_JOURNAL_RECORDS ? i + 1 : 0;
+        }
+      }
+    }
+
+    first_block = first;
+    return true;
+  }
+
+  /**
+   * One sector write, the volume cache is the buffer
+   */
+  void Journal::write(const uint32_t sdpos, const float position[XYZE]) {
+    cache_t* buffer = card.fat.vol()->cacheClear();
+    if (!buffer) return;
+
+    memset(buffer->data, 0, 512);
+    journal_record_t &r = *(journal_record_t*)buffer->data;
+
+    r.magic = JOURNAL_MAGIC;
+    r.seq = ++seq;
+    r.sdpos = sdpos;
+    memcpy(r.position, position, sizeof(r.position));
+    r.feedrate_mm_s = mechanics.feedrate_mm_s;
+    r.feedrate_percentage = mechanics.feedrate_percentage;
+    LOOP_HEATER() r.target_temperature[h] = heaters[h].target_temperature;
+    #if FAN_COUNT > 0
+      LOOP_FAN() r.fan_speed[f] = fans[f].Speed;
+    #endif
+    r.active_extruder = tools.active_extruder;
+    #if HAS_LEVELING
+      r.leveling = bedlevel.leveling_is_active();
+    #endif
+    r.relative_mode = printer.relative_mode;
+    r.relative_e = printer.axis_relative_modes[E_AXIS];
+    r.dir_block = card.gcode_file.dirBlock_;
+    r.dir_index = card.gcode_file.dirIndex_;
+    r.first_cluster = card.gcode_file.firstCluster();
+    r.file_size = card.fileSize;
+    strncpy(r.name, card.fileName, JOURNAL_NAME_SIZE - 1);
+    r.crc = journal_crc(buffer->data, offsetof(journal_record_t, crc));
+
+    if (!card.writeBlock(first_block + slot, buffer->data)) {
+      SERIAL_LM(ER, "Journal write error");
+      return;
+    }
+    if (++slot == POWER_LOSS_JOURNAL_RECORDS) slot = 0;
+  }
+
+  bool Journal::valid(const journal_record_t &r) {
+    return r.magic == JOURNAL_MAGIC && r.seq && r.crc == journal_crc((const uint8_t*)&r, offsetof(journal_record_t, crc));
+  }
+
+  bool Journal::load() {
+    if (!open()) return false;
+
+    cache_t* buffer = card.fat.vol()->cacheClear();
+    if (!buffer) return false;
+
+    bool found = false;
+    for (uint8_t i = 0; i < POWER_LOSS_JOURNAL_RECORDS; i++) {
+      if (!card.readBlock(first_block + i, buffer->data)) return false;
+      const journal_record_t &r = *(journal_record_t*)buffer->data;
+      if (valid(r) && (!found || r.seq > rec.seq)) {
+        rec = r;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  void Journal::report() {
+    if (!load()) {
+      SERIAL_EM("No journal");
+      return;
+    }
+
+    SERIAL_MV("Journal record:", rec.seq);
+    if (rec.sdpos == JOURNAL_NO_SDPOS) {
+      SERIAL_EM(" print ended, nothing to resume");
+      return;
+    }
+
+    SERIAL_MT(" file:", rec.name);
+    SERIAL_MV(" pos:", rec.sdpos);
+    SERIAL_EMV("/", rec.file_size);
+    SERIAL_MV("X:", rec.position[X_AXIS], 3);
+    SERIAL_MV(" Y:", rec.position[Y_AXIS], 3);
+    SERIAL_MV(" Z:", rec.position[Z_AXIS], 3);
+    SERIAL_MV(" E:", rec.position[E_AXIS], 3);
+    SERIAL_MV(" F:", rec.feedrate_mm_s * 60.0, 0);
+    SERIAL_EMV(" S:", (int)rec.feedrate_percentage);
+    LOOP_HEATER() {
+      SERIAL_MV(" H", (int)h);
+      SERIAL_MV(":", (int)rec.target_temperature[h]);
+    }
+    #if FAN_COUNT > 0
+      LOOP_FAN() {
+        SERIAL_MV(" P", (int)f);
+        SERIAL_MV(":", rec.fan_speed[f]);
+      }
+    #endif
+    SERIAL_EOL();
+    SERIAL_MV("T:", (int)rec.active_extruder);
+    SERIAL_MV(" Leveling:", (int)rec.leveling);
+    SERIAL_MV(" G9", rec.relative_mode ? 1 : 0);
+    SERIAL_EMV(" M8", rec.relative_e ? 3 : 2);
+  }
+
+  void Journal::resume() {
+    if (card.sdprinting || resume_step) {
+      SERIAL_LM(ER, "Busy, can't resume");
+      return;
+    }
+    if (!load() || rec.sdpos == JOURNAL_NO_SDPOS) {
+      SERIAL_LM(ER, "Nothing to resume");
+      return;
+    }
+    SERIAL_LMT(ECHO, "Resume ", rec.name);
+    resume_step = RESUME_G90;
+    resume_index = 0;
+  }
+
+  void Journal::resume_continue() {
+    stepper.synchronize();
+    if (card.sdprinting || !load() || rec.sdpos == JOURNAL_NO_SDPOS) {
+      SERIAL_LM(ER, "Nothing to resume");
+      return;
+    }
+    if (!card.reopenFile(rec.dir_block, rec.dir_index, rec.first_cluster, rec.file_size, rec.name)) return;
+
+    card.setIndex(rec.sdpos);
+    card.startFileprint();
+    print_job_counter.start();
+  }
+
+  /**
+   * The command of the current resume step in cmd, steps that don't
+   * apply are skipped. False once all are queued.
+   */
+  bool Journal::resume_line(char* cmd) {
+    char* p = cmd;
+    for (;;) {
+      switch (resume_step) {
+
+        case RESUME_G90:
+          strcpy_P(cmd, PSTR("G90"));
+          return true;
+
+        case RESUME_HEAT:
+        case RESUME_WAIT:
+          for (; resume_index < HEATER_COUNT; resume_index++) {
+            const uint8_t h = resume_index;
+            const int16_t temp = rec.target_temperature[h];
+            if (temp <= 0) continue;
+            #if HAS_HEATER_BED
+              if (h == BED_INDEX) {
+                sprintf_P(cmd, resume_step == RESUME_HEAT ? PSTR("M140 S%i") : PSTR("M190 S%i"), (int)temp);
+                return true;
+              }
+            #endif
+            if (h < HOTENDS) {
+              sprintf_P(cmd, resume_step == RESUME_HEAT ? PSTR("M104 T%i S%i") : PSTR("M109 T%i S%i"), (int)h, (int)temp);
+              return true;
+            }
+          }
+          break;
+
+        case RESUME_SET_Z:
+        case RESUME_LIFT:
+          #if !MECH(DELTA)
+            // Z has not moved without power, homing it would hit the print
+            strcpy_P(cmd, resume_step == RESUME_SET_Z ? PSTR("G92") : PSTR("G1"));
+            p = add_value(cmd + strlen(cmd), 'Z', rec.position[Z_AXIS] + (resume_step == RESUME_SET_Z ? 0 : JOURNAL_Z_LIFT));
+            if (resume_step == RESUME_LIFT) strcpy_P(p, PSTR(" F600"));
+            return true;
+          #endif
+          break;
+
+        case RESUME_HOME:
+          #if MECH(DELTA)
+            strcpy_P(cmd, PSTR("G28"));
+          #else
+            strcpy_P(cmd, PSTR("G28 X Y"));
+          #endif
+          return true;
+
+        case RESUME_TOOL:
+          sprintf_P(cmd, PSTR("T%i"), (int)rec.active_extruder);
+          return true;
+
+        case RESUME_LEVEL:
+          if (rec.leveling) {
+            #if ENABLED(MESH_BED_LEVELING)
+              strcpy_P(cmd, PSTR("M420 S1"));
+              return true;
+            #elif HAS_ABL
+              strcpy_P(cmd, PSTR("M320 S1"));
+              return true;
+            #endif
+          }
+          break;
+
+        case RESUME_PURGE_E:
+          if (POWER_LOSS_JOURNAL_PURGE > 0) {
+            strcpy_P(cmd, PSTR("G92 E0"));
+            return true;
+          }
+          break;
+
+        case RESUME_PURGE:
+          if (POWER_LOSS_JOURNAL_PURGE > 0) {
+            strcpy_P(cmd, PSTR("G1"));
+            p = add_value(cmd + 2, 'E', POWER_LOSS_JOURNAL_PURGE);
+            strcpy_P(p, PSTR(" F300"));
+            return true;
+          }
+          break;
+
+        case RESUME_XY:
+          strcpy_P(cmd, PSTR("G1"));
+          p = add_value(cmd + 2, 'X', rec.position[X_AXIS]);
+          p = add_value(p, 'Y', rec.position[Y_AXIS]);
+          strcpy_P(p, PSTR(" F3600"));
+          return true;
+
+        case RESUME_Z:
+          strcpy_P(cmd, PSTR("G1"));
+          p = add_value(cmd + 2, 'Z', rec.position[Z_AXIS]);
+          strcpy_P(p, PSTR(" F600"));
+          return true;
+
+        case RESUME_E:
+          strcpy_P(cmd, PSTR("G92"));
+          add_value(cmd + 3, 'E', rec.position[E_AXIS]);
+          return true;
+
+        case RESUME_FAN:
+          #if FAN_COUNT > 0
+            for (; resume_index < FAN_COUNT; resume_index++) {
+              if (!rec.fan_speed[resume_index]) continue;
+              sprintf_P(cmd, PSTR("M106 S%u P%i"), (unsigned int)rec.fan_speed[resume_index], (int)resume_index);
+              return true;
+            }
+          #endif
+          break;
+
+        case RESUME_SPEED:
+          sprintf_P(cmd, PSTR("M220 S%i"), (int)rec.feedrate_percentage);
+          return true;
+
+        case RESUME_FEEDRATE:
+          strcpy_P(cmd, PSTR("G1"));
+          add_value(cmd + 2, 'F', rec.feedrate_mm_s * 60.0);
+          return true;
+
+        // Modes last, the commands above are absolute
+        case RESUME_MODE:
+          if (rec.relative_mode) {
+            strcpy_P(cmd, PSTR("G91"));
+            return true;
+          }
+          break;
+
+        case RESUME_MODE_E:
+          strcpy_P(cmd, rec.relative_e ? PSTR("M83") : PSTR("M82"));
+          return true;
+
+        case RESUME_CONTINUE:
+          strcpy_P(cmd, PSTR("M414 C"));
+          return true;
+
+        default:
+          resume_step = RESUME_NONE;
+          return false;
+      }
+
+      // Nothing to queue for this step
+      resume_step++;
+      resume_index = 0;
+    }
+  }
+
+#endif // HAS_POWER_LOSS_JOURNAL
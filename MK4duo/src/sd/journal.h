@@ -0,0 +1,148 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * journal.h
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_
+
+#define JOURNAL_NO_SDPOS  0xFFFFFFFF  // Not a line of the SD file, or no print to resume
+
+#if HAS_POWER_LOSS_JOURNAL
+
+  #define JOURNAL_FILE      "JOURNAL.BIN"
+  #define JOURNAL_MAGIC     0x4C4E524AUL  // "JRNL"
+  #define JOURNAL_NAME_SIZE 64
+
+  /**
+   * One sector of JOURNAL.BIN. The valid record with the
+   * highest seq is the newest, crc covers all that comes before it.
+   */
+  typedef struct {
+    uint32_t  magic,
+              seq,
+              sdpos;                          // Line to run again, JOURNAL_NO_SDPOS once the print ended
+    float     position[XYZE],                 // Logical position before that line
+              feedrate_mm_s;
+    int16_t   feedrate_percentage,
+              target_temperature[HEATER_COUNT];
+    #if FAN_COUNT > 0
+      uint16_t fan_speed[FAN_COUNT];
+    #endif
+    uint8_t   active_extruder;
+    bool      leveling,
+              relative_mode,
+              relative_e;
+    uint32_t  dir_block,                      // Where the folder entry of the file is
+              first_cluster,
+              file_size;
+    uint8_t   dir_index;
+    char      name[JOURNAL_NAME_SIZE];        // As it was selected, for the report
+    uint16_t  crc;
+  } journal_record_t;
+
+  class Journal {
+
+    public: /** Constructor */
+
+      Journal() {}
+
+    public: /** Public Parameters */
+
+      static journal_record_t rec;            // Read by load()
+
+    private: /** Private Parameters */
+
+      static uint32_t cmd_sdpos,              // Line of the command being run
+                      first_block,            // First sector of JOURNAL.BIN, 0 = not open
+                      seq;
+      static float    cmd_position[XYZE],     // Position before the command being run
+                      max_z;
+      static millis_t next_ms,
+                      write_ms;
+      static uint8_t  slot,                   // Sector the next record goes to
+                      resume_step,
+                      resume_index;
+      static bool     active;                 // Records written for the print
+
+    public: /** Public Function */
+
+      /**
+       * Header of each queued command before it runs, NULL after
+       */
+      static void command(const char* sdpos);
+
+      /**
+       * Tag a new planner block with the line that planned it
+       */
+      static void plan(block_t* block);
+
+      /**
+       * Write a record when it is due, and feed the resume commands
+       */
+      static void idle();
+
+      /**
+       * The print ended or was stopped, nothing to resume
+       */
+      static void finish();
+
+      /**
+       * Forget JOURNAL.BIN, after the card changed
+       */
+      FORCE_INLINE static void reset() { first_block = 0; active = false; resume_step = 0; }
+
+      /**
+       * Newest valid record into rec
+       */
+      static bool load();
+
+      /**
+       * M413 report of the newest record
+       */
+      static void report();
+
+      /**
+       * M414 queues the commands that bring the printer back to
+       * the newest record, then M414 C continues the file
+       */
+      static void resume();
+      static void resume_continue();
+
+    private: /** Private Function */
+
+      static bool open();
+      static void write(const uint32_t sdpos, const float position[XYZE]);
+      static bool valid(const journal_record_t &r);
+      static bool resume_line(char* cmd);
+
+  };
+
+  extern Journal journal;
+
+#endif // HAS_POWER_LOSS_JOURNAL
+
+#endif /* _JOURNAL_H_ */
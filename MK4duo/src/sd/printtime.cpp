@@ -0,0 +1,237 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * printtime.cpp
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#include "../../base.h"
+
+#if HAS_SD_PRINT_TIME
+
+  PrintTime printtime;
+
+  shadow_block_t  PrintTime::block[SD_PRINT_TIME_BLOCKS];
+  uint8_t         PrintTime::tail   = 0,
+                  PrintTime::count  = 0;
+  float           PrintTime::time   = 0.0,
+                  PrintTime::previous_speed[XYZE],
+                  PrintTime::previous_nominal_speed = 0.0,
+                  PrintTime::previous_safe_speed    = 0.0;
+
+  // Speed at the start of a distance that still reaches target_velocity at its end
+  static float max_allowable_speed(const float &accel, const float &target_velocity, const float &distance) {
+    return SQRT(sq(target_velocity) - 2 * accel * distance);
+  }
+
+  void PrintTime::reset() {
+    tail = count = 0;
+    time = previous_nominal_speed = previous_safe_speed = 0.0;
+    ZERO(previous_speed);
+  }
+
+  void PrintTime::move(const float delta[XYZE], float fr_mm_s, const uint8_t extruder) {
+    const float xyz_mm = SQRT(sq(delta[X_AXIS]) + sq(delta[Y_AXIS]) + sq(delta[Z_AXIS]));
+    const bool  xyz = xyz_mm >= 0.001,
+                esteps = delta[E_AXIS] != 0.0;
+    const float millimeters = xyz ? xyz_mm : FABS(delta[E_AXIS]);
+    NOLESS(fr_mm_s, esteps ? mechanics.min_feedrate_mm_s : mechanics.min_travel_feedrate_mm_s);
+    if (millimeters < 0.001 || fr_mm_s <= 0.0) return;
+
+    const float inverse_mm_s = fr_mm_s / millimeters;
+
+    if (count == SD_PRINT_TIME_BLOCKS) release();
+    uint8_t head = tail + count;
+    if (head >= SD_PRINT_TIME_BLOCKS) head -= SD_PRINT_TIME_BLOCKS;
+    shadow_block_t &b = block[head];
+    count++;
+
+    b.millimeters = millimeters;
+    b.nominal_speed = fr_mm_s;
+
+    // Speed limits of each axis
+    float current_speed[XYZE], speed_factor = 1.0;
+    LOOP_XYZE(i) {
+      const float cs = FABS(current_speed[i] = delta[i] * inverse_mm_s);
+      const uint8_t a = i == E_AXIS ? i + extruder : i;
+      if (cs > mechanics.max_feedrate_mm_s[a]) NOMORE(speed_factor, mechanics.max_feedrate_mm_s[a] / cs);
+    }
+    if (speed_factor < 1.0) {
+      LOOP_XYZE(i) current_speed[i] *= speed_factor;
+      b.nominal_speed *= speed_factor;
+    }
+
+    // Print, travel or retract acceleration, within the limit of each axis
+    if (!xyz)
+      b.acceleration = mechanics.retract_acceleration[extruder];
+    else {
+      b.acceleration = esteps ? mechanics.acceleration : mechanics.travel_acceleration;
+      LOOP_XYZE(i) {
+        const float d = FABS(delta[i]);
+        const uint8_t a = i == E_AXIS ? i + extruder : i;
+        if (d > 0.0) NOMORE(b.acceleration, mechanics.max_acceleration_mm_per_s2[a] * millimeters / d);
+      }
+    }
+
+    // Junction speed from the jerk of each axis, as the planner does
+    float safe_speed = b.nominal_speed, vmax_junction;
+    uint8_t limited = 0;
+    LOOP_XYZE(i) {
+      const float jerk = FABS(current_speed[i]),
+                  maxj = (i == E_AXIS) ? mechanics.max_jerk[i + extruder] : mechanics.max_jerk[i];
+      if (jerk > maxj) {
+        if (limited) {
+          const float mjerk = maxj * b.nominal_speed;
+          if (jerk * safe_speed > mjerk) safe_speed = mjerk / jerk;
+        }
+        else {
+          ++limited;
+          safe_speed = maxj;
+        }
+      }
+    }
+
+    if (count > 1 && previous_nominal_speed > 0.0001) {
+      const bool prev_speed_larger = previous_nominal_speed > b.nominal_speed;
+      const float smaller_speed_factor = prev_speed_larger ? (b.nominal_speed / previous_nominal_speed) : (previous_nominal_speed / b.nominal_speed);
+      vmax_junction = prev_speed_larger ? b.nominal_speed : previous_nominal_speed;
+      float v_factor = 1.0;
+      limited = 0;
+      LOOP_XYZE(axis) {
+        float v_exit = previous_speed[axis], v_entry = current_speed[axis];
+        const float maxj = (axis == E_AXIS) ? mechanics.max_jerk[axis + extruder] : mechanics.max_jerk[axis];
+        if (prev_speed_larger) v_exit *= smaller_speed_factor;
+        if (limited) {
+          v_exit *= v_factor;
+          v_entry *= v_factor;
+        }
+        const float jerk = (v_exit > v_entry)
+            ? ((v_entry > 0.0 || v_exit < 0.0) ? (v_exit - v_entry) : max(v_exit, -v_entry))
+            : ((v_entry < 0.0 || v_exit > 0.0) ? (v_entry - v_exit) : max(-v_exit, v_entry));
+        if (jerk > maxj) {
+          v_factor *= maxj / jerk;
+          ++limited;
+        }
+      }
+      if (limited) vmax_junction *= v_factor;
+      const float vmax_junction_threshold = vmax_junction * 0.99;
+      if (previous_safe_speed > vmax_junction_threshold && safe_speed > vmax_junction_threshold)
+        vmax_junction = safe_speed;
+    }
+    else
+      vmax_junction = safe_speed;
+
+    b.max_entry_speed = vmax_junction;
+    const float v_allowable = max_allowable_speed(-b.acceleration, MINIMUM_PLANNER_SPEED, millimeters);
+    b.entry_speed = min(vmax_junction, v_allowable);
+    b.nominal_length = b.nominal_speed <= v_allowable;
+
+    COPY_ARRAY(previous_speed, current_speed);
+    previous_nominal_speed = b.nominal_speed;
+    previous_safe_speed = safe_speed;
+
+    recalculate();
+  }
+
+  void PrintTime::dwell(const float &seconds) {
+    finish();
+    time += seconds;
+  }
+
+  float PrintTime::elapsed() {
+    float t = time;
+    for (uint8_t n = 0, i = tail; n < count; n++) {
+      t += block[i].millimeters / block[i].nominal_speed;
+      if (++i == SD_PRINT_TIME_BLOCKS) i = 0;
+    }
+    return t;
+  }
+
+  float PrintTime::finish() {
+    while (count) release();
+    previous_nominal_speed = 0.0;
+    return time;
+  }
+
+  /**
+   * The reverse and forward passes of the planner. The oldest
+   * move is left alone, as if the stepper were running it.
+   */
+  void PrintTime::recalculate() {
+    if (count < 2) return;
+
+    uint8_t i = tail + count - 1;
+    if (i >= SD_PRINT_TIME_BLOCKS) i -= SD_PRINT_TIME_BLOCKS;
+    for (uint8_t n = count - 1; --n;) {
+      const shadow_block_t &next = block[i];
+      i = i ? i - 1 : SD_PRINT_TIME_BLOCKS - 1;
+      shadow_block_t &current = block[i];
+      if (current.entry_speed != current.max_entry_speed) {
+        current.entry_speed = (current.nominal_length || current.max_entry_speed <= next.entry_speed)
+          ? current.max_entry_speed
+          : min(current.max_entry_speed, max_allowable_speed(-current.acceleration, next.entry_speed, current.millimeters));
+      }
+    }
+
+    i = tail;
+    for (uint8_t n = count; --n;) {
+      const shadow_block_t &previous = block[i];
+      if (++i == SD_PRINT_TIME_BLOCKS) i = 0;
+      shadow_block_t &current = block[i];
+      if (!previous.nominal_length && previous.entry_speed < current.entry_speed)
+        NOMORE(current.entry_speed, max_allowable_speed(-previous.acceleration, previous.entry_speed, previous.millimeters));
+    }
+  }
+
+  /**
+   * Time of the oldest move from its trapezoid: entry_speed up
+   * to nominal_speed, then down to the entry of the next move
+   */
+  void PrintTime::release() {
+    const shadow_block_t &b = block[tail];
+    if (++tail == SD_PRINT_TIME_BLOCKS) tail = 0;
+    count--;
+
+    const float vi = b.entry_speed,
+                vf = count ? block[tail].entry_speed : MINIMUM_PLANNER_SPEED,
+                vn = b.nominal_speed,
+                a2 = 2.0 * b.acceleration,
+                accelerate = (sq(vn) - sq(vi)) / a2,
+                decelerate = (sq(vn) - sq(vf)) / a2;
+
+    if (b.acceleration <= 0.0)
+      time += b.millimeters / vn;
+    else if (accelerate + decelerate <= b.millimeters)
+      time += (2.0 * vn - vi - vf) / b.acceleration + (b.millimeters - accelerate - decelerate) / vn;
+    else {
+      // Nominal speed is not reached
+      const float peak = SQRT((a2 * b.millimeters + sq(vi) + sq(vf)) * 0.5);
+      if (peak >= max(vi, vf))
+        time += (2.0 * peak - vi - vf) / b.acceleration;
+      else
+        time += 2.0 * b.millimeters / (vi + vf);
+    }
+  }
+
+#endif // HAS_SD_PRINT_TIME
@@ -0,0 +1,107 @@
+/**
+ * MK4duo Firmware for 3D Printer, Laser and CNC
+ *
+ * Based on Marlin, Sprinter and grbl
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ * Copyright (C) 2013 Alberto Cotronei @MagoKimbra
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * printtime.h
+ *
+ * Copyright (C) 2017 Alberto Cotronei @MagoKimbra
+ */
+
+#ifndef _PRINTTIME_H_
+#define _PRINTTIME_H_
+
+#if HAS_SD_PRINT_TIME
+
+  /**
+   * A move as the planner would keep it, in mm
+   */
+  typedef struct {
+    float millimeters,
+          nominal_speed,            // mm/s
+          acceleration,             // mm/s^2
+          max_entry_speed,
+          entry_speed;
+    bool  nominal_length;           // Reaches max_entry_speed whatever the neighbours
+  } shadow_block_t;
+
+  /**
+   * Shadow planner for the print time of a file. The moves of the
+   * G-code scan go through the limits, jerk and look-ahead passes
+   * of Planner::_buffer_line, nothing is stepped. A move is timed
+   * from its trapezoid when it leaves the look-ahead.
+   */
+  class PrintTime {
+
+    public: /** Constructor */
+
+      PrintTime() {}
+
+    private: /** Private Parameters */
+
+      static shadow_block_t block[SD_PRINT_TIME_BLOCKS];
+      static uint8_t  tail,                       // Oldest move
+                      count;
+      static float    time,                       // Seconds of the moves gone
+                      previous_speed[XYZE],
+                      previous_nominal_speed,
+                      previous_safe_speed;
+
+    public: /** Public Function */
+
+      /**
+       * Empty, from the start of a file
+       */
+      static void reset();
+
+      /**
+       * A move by delta mm at fr_mm_s
+       */
+      static void move(const float delta[XYZE], float fr_mm_s, const uint8_t extruder);
+
+      /**
+       * G4 and the like, the moves before it end first
+       */
+      static void dwell(const float &seconds);
+
+      /**
+       * Seconds up to the last move, the ones still in the
+       * look-ahead counted at their nominal speed
+       */
+      static float elapsed();
+
+      /**
+       * Seconds of the whole file, the last move stops
+       */
+      static float finish();
+
+    private: /** Private Function */
+
+      static void recalculate();
+      static void release();
+
+  };
+
+  extern PrintTime printtime;
+
+#endif // HAS_SD_PRINT_TIME
+
+#endif /* _PRINTTIME_H_ */
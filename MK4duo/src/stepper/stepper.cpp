@@ -1553,6 +1553,16 @@ long Stepper::position(AxisEnum axis) {
   return machine_pos;
 }
 
+void Stepper::snapshot(stepper_snapshot_t &snap) {
+  CRITICAL_SECTION_START;
+  LOOP_XYZE(i) snap.position[i] = machine_position[i];
+  snap.block = planner.block_buffer_tail;
+  snap.moving = current_block != NULL;
+  snap.step_events_completed = snap.moving ? step_events_completed : 0;
+  snap.step_event_count = snap.moving ? current_block->step_event_count : 0;
+  CRITICAL_SECTION_END;
+}
+
 void Stepper::enable_all_steppers() {
 
   #if HAS_POWER_SWITCH 
@@ -49,6 +49,18 @@
 
 #include "stepper_indirection.h"
 
+/**
+ * Stepper counts and progress of the block being traced,
+ * as the stepper ISR sees them at one instant
+ */
+typedef struct {
+  long      position[NUM_AXIS];     // Steps of each stepper
+  uint8_t   block;                  // Planner index of the block being traced
+  bool      moving;                 // A block is being traced
+  uint32_t  step_events_completed,  // Step events of that block done so far
+            step_event_count;       // and to do in all
+} stepper_snapshot_t;
+
 class Stepper {
 
   public: /** Constructor */
@@ -190,6 +202,11 @@ class Stepper {
     //
     static void report_positions();
 
+    //
+    // Take positions and block progress together, without waiting for the moves
+    //
+    static void snapshot(stepper_snapshot_t &snap);
+
     //
     // SCARA AB axes are in degrees, not mm
     //
@@ -675,6 +675,7 @@ void Temperature::disable_all_heaters() {
 #if ENABLED(AUTO_REPORT_TEMPERATURES)
   void Temperature::auto_report_temperatures() {
     if (auto_report_temp_interval && ELAPSED(millis(), next_temp_report_ms)) {
+      if (serial_skip_optional()) return;   // Deferred until the TX buffer drains
       next_temp_report_ms = millis() + 1000UL * auto_report_temp_interval;
       print_heaterstates();
       SERIAL_EOL();
@@ -22,6 +22,55 @@
 
 #include "../../base.h"
 
+uint8_t ultostr(char *buf, uint32_t n) {
+  char tmp[10];
+  uint8_t len = 0;
+  do {
+    const uint32_t q = n / 10;
+    tmp[len++] = '0' + (uint8_t)(n - q * 10);
+    n = q;
+  } while (n);
+  for (uint8_t i = 0; i < len; i++) buf[i] = tmp[len - 1 - i];
+  buf[len] = '\0';
+  return len;
+}
+
+/**
+ * One float split of integer and fraction, the fraction scaled and
+ * rounded once, then all digits from integers. Rounding carries into
+ * the integer part, so print(1.999, 2) gives "2.00".
+ */
+uint8_t ftostrn(char *buf, float x, uint8_t digits) {
+  static const uint32_t scale[10] PROGMEM = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+  if (isnan(x)) { strcpy_P(buf, PSTR("NAN")); return 3; }
+  if (isinf(x)) { strcpy_P(buf, PSTR("INF")); return 3; }
+
+  NOMORE(digits, 9);
+  const bool neg = x < 0;
+  if (neg) x = -x;
+
+  const uint32_t s = pgm_read_dword(&scale[digits]);
+  uint32_t ip = (uint32_t)x,
+           fp = (uint32_t)((x - (float)ip) * (float)s + 0.5f);
+  if (fp >= s) { fp -= s; ip++; }
+
+  uint8_t len = 0;
+  if (neg && (ip || fp)) buf[len++] = '-';
+  len += ultostr(buf + len, ip);
+  if (digits) {
+    buf[len++] = '.';
+    for (uint8_t i = digits; i--;) {
+      const uint32_t q = fp / 10;
+      buf[len + i] = '0' + (uint8_t)(fp - q * 10);
+      fp = q;
+    }
+    len += digits;
+  }
+  buf[len] = '\0';
+  return len;
+}
+
 #if HAS_LCD
 
   char conv[8] = { 0 };
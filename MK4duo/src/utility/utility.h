@@ -80,4 +80,13 @@
 
 #endif // ULTRA_LCD || NEXTION
 
+// Room for the longest ultostr or ftostrn string and its terminator
+#define NUMBER_STR_SIZE 22
+
+// Convert unsigned long to decimal string, return its length
+uint8_t ultostr(char *buf, uint32_t n);
+
+// Convert float to string with up to 9 decimals, digits found in integer math, return its length
+uint8_t ftostrn(char *buf, float x, uint8_t digits);
+
 #endif // __UTILITY_H__